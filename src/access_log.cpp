@@ -0,0 +1,285 @@
+#include "access_log.h"
+
+#include <boost/json.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <iterator>
+#include <unistd.h>
+
+namespace access_log {
+
+namespace json = boost::json;
+
+namespace {
+
+// Local time as to_iso_extended_string of second_clock::local_time() gives, the text is reused within a second
+std::string_view FormatTimestamp(std::chrono::system_clock::time_point time) {
+    thread_local std::time_t last_time = -1;
+    thread_local char text[32];
+    thread_local size_t text_size = 0;
+
+    std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+
+    if (seconds != last_time) {
+        std::tm local{};
+        localtime_r(&seconds, &local);
+
+        text_size = std::strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &local);
+        last_time = seconds;
+    }
+
+    return {text, text_size};
+}
+
+} // namespace
+
+void Record::SetText(std::string_view value) noexcept {
+    text_size = static_cast<std::uint16_t>(std::min(value.size(), TEXT_SIZE));
+    std::copy_n(value.data(), text_size, text.data());
+}
+
+void Record::SetUri(std::string_view uri) noexcept {
+    size_t query = uri.find('?');
+    SetText(uri.substr(0, query));
+
+    if (query == std::string_view::npos) {
+        return;
+    }
+
+    auto append = [this] (std::string_view value) {
+        size_t size = std::min(value.size(), TEXT_SIZE - text_size);
+        std::copy_n(value.data(), size, text.data() + text_size);
+        text_size += static_cast<std::uint16_t>(size);
+    };
+
+//  *   Every parameter is copied with the '?' or '&' before it
+    for (std::string_view rest = uri.substr(query); !rest.empty();) {
+        size_t next = rest.find('&', 1);
+        std::string_view param = rest.substr(0, next);
+        rest = next == std::string_view::npos ? std::string_view{} : rest.substr(next);
+
+        size_t eq = param.find('=');
+        std::string_view name = param.substr(1, eq == std::string_view::npos ? eq : eq - 1);
+
+        if (eq != std::string_view::npos && std::find(std::begin(MASKED_PARAMS), std::end(MASKED_PARAMS), name) != std::end(MASKED_PARAMS)) {
+            append(param.substr(0, eq + 1));
+            append(MASK);
+        } else {
+            append(param);
+        }
+    }
+}
+
+RingBuffer::RingBuffer(size_t capacity)
+    : slots_(std::bit_ceil(std::max(capacity, size_t{2})))
+    , mask_(slots_.size() - 1) {
+}
+
+bool RingBuffer::TryPush(const Record & record) noexcept {
+    size_t head = head_.load(std::memory_order_relaxed);
+
+    if (head - tail_.load(std::memory_order_acquire) == slots_.size()) {
+        return false;
+    }
+
+    slots_[head & mask_] = record;
+    head_.store(head + 1, std::memory_order_release);
+
+    return true;
+}
+
+Logger::Logger() : dropped_{metrics::Registry::Instance().GetCounter("log_records_dropped_total")} {
+}
+
+Logger::~Logger() {
+    Stop();
+}
+
+void Logger::Start(Config config) {
+    config_ = config;
+    sample_rate_.store(std::max(config_.sample_rate, 1u), std::memory_order_relaxed);
+    batch_.reserve(config_.batch_size * 2);
+
+    thread_ = std::jthread([this] (std::stop_token stop_token) {
+        Run(stop_token);
+    });
+
+    started_.store(true, std::memory_order_release);
+}
+
+void Logger::Stop() {
+    if (!started_.exchange(false)) {
+        return;
+    }
+
+    thread_.request_stop();
+    thread_.join();
+}
+
+bool Logger::SampleRequest() noexcept {
+    unsigned sample_rate = sample_rate_.load(std::memory_order_relaxed);
+    if (sample_rate <= 1) {
+        return true;
+    }
+
+    thread_local unsigned counter = 0;
+    return ++counter % sample_rate == 0;
+}
+
+void Logger::LogRequest(const net::ip::address & ip, std::string_view uri, http::verb method) noexcept {
+    Record record;
+    record.event = Event::REQUEST;
+    record.time = std::chrono::system_clock::now();
+    record.ip = ip;
+    record.method = method;
+    record.SetUri(uri);
+
+    Push(record);
+}
+
+void Logger::LogResponse(int code, std::chrono::milliseconds response_time, std::string_view content_type) noexcept {
+    Record record;
+    record.event = Event::RESPONSE;
+    record.time = std::chrono::system_clock::now();
+    record.code = code;
+    record.response_time = response_time.count();
+    record.SetText(content_type);
+
+    Push(record);
+}
+
+void Logger::LogError(const sys::error_code & ec, const char * where) noexcept {
+    Record record;
+    record.event = Event::ERROR;
+    record.time = std::chrono::system_clock::now();
+    record.code = ec.value();
+    record.category = &ec.category();
+    record.where = where;
+
+    Push(record);
+}
+
+void Logger::Format(const Record & record, std::string & out) {
+    json::object data;
+    std::string_view message;
+
+    switch (record.event) {
+        case Event::REQUEST: {
+            auto method = http::to_string(record.method);
+
+            data["ip"] = record.ip.to_string();
+            data["URI"] = record.GetText();
+            data["method"] = std::string_view{method.data(), method.size()};
+            message = "request received";
+            break;
+        }
+        case Event::RESPONSE:
+            data["code"] = record.code;
+            data["response_time"] = record.response_time;
+            data["content_type"] = record.GetText();
+            message = "response sent";
+            break;
+        case Event::ERROR:
+            data["code"] = record.code;
+            data["text"] = record.category ? record.category->message(record.code) : std::string{};
+            data["where"] = record.where;
+            message = "error";
+            break;
+    }
+
+    json::object log_message_obj;
+    log_message_obj["timestamp"] = FormatTimestamp(record.time);
+    log_message_obj["data"] = std::move(data);
+    log_message_obj["message"] = message;
+
+    out += json::serialize(log_message_obj);
+}
+
+void Logger::Push(const Record & record) noexcept {
+    if (!started_.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    RingBuffer * buffer = GetThreadBuffer();
+
+    if (!buffer || !buffer->TryPush(record)) {
+        dropped_.Increment();
+    }
+}
+
+// The buffer is created on the first record of a thread and is kept by the logger until it stops
+RingBuffer * Logger::GetThreadBuffer() noexcept {
+    thread_local RingBuffer * buffer = nullptr;
+
+    if (!buffer) {
+        try {
+            auto created = std::make_shared<RingBuffer>(config_.buffer_size);
+
+            std::lock_guard lock{buffers_mutex_};
+            buffers_.emplace_back(created);
+            buffer = created.get();
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
+    return buffer;
+}
+
+void Logger::Run(std::stop_token stop_token) {
+    while (!stop_token.stop_requested()) {
+        {
+            std::unique_lock lock{wake_mutex_};
+            wake_cv_.wait_for(lock, stop_token, config_.flush_interval, [] { return false; });
+        }
+
+        Drain();
+    }
+
+    Drain();
+}
+
+void Logger::Drain() {
+    std::vector<std::shared_ptr<RingBuffer>> buffers;
+    {
+        std::lock_guard lock{buffers_mutex_};
+        buffers = buffers_;
+    }
+
+    for (const std::shared_ptr<RingBuffer> & buffer : buffers) {
+        buffer->Drain([this] (const Record & record) {
+            Format(record, batch_);
+            batch_ += '\n';
+
+            if (batch_.size() >= config_.batch_size) {
+                Write();
+            }
+        });
+    }
+
+    Write();
+}
+
+// A failed write loses the batch, the log must not stop the server
+void Logger::Write() {
+    std::string_view rest{batch_};
+
+    while (!rest.empty()) {
+        ssize_t written = ::write(config_.fd, rest.data(), rest.size());
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        rest.remove_prefix(static_cast<size_t>(written));
+    }
+
+    batch_.clear();
+}
+
+} // namespace access_log
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <boost/asio/ip/address.hpp>
+#include <boost/beast/http/verb.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "metrics.h"
+
+// Asynchronous access log.
+//
+// IO threads only copy a fixed size record into their own lock-free ring buffer, a background thread
+// formats the records as JSON lines (the format of ConsoleJsonFormatter) and writes them in batches.
+// A record that does not fit into a full ring is dropped and counted in log_records_dropped_total,
+// the request is never delayed by the log.
+namespace access_log {
+
+namespace net = boost::asio;
+namespace http = boost::beast::http;
+namespace sys = boost::system;
+
+enum class Event : std::uint8_t {
+    REQUEST,
+    RESPONSE,
+    ERROR
+};
+
+// Access tokens may come in the query string (WebSocket clients can't set headers), they never reach the log
+inline constexpr std::string_view MASKED_PARAMS[] = {"token"};
+inline constexpr std::string_view MASK = "***";
+
+// Longer URIs and content types are cut
+struct Record {
+    static constexpr size_t TEXT_SIZE = 200;
+
+    Event event = Event::REQUEST;
+    std::chrono::system_clock::time_point time;
+    // REQUEST
+    net::ip::address ip;
+    http::verb method = http::verb::unknown;
+    // RESPONSE: status, ERROR: error value
+    int code = 0;
+    std::int64_t response_time = 0;
+    // ERROR, the text is looked up by the writer
+    const sys::error_category * category = nullptr;
+    const char * where = "";
+    // REQUEST: URI, RESPONSE: content type
+    std::uint16_t text_size = 0;
+    std::array<char, TEXT_SIZE> text;
+
+    void SetText(std::string_view value) noexcept;
+
+    // Sets a request URI as the text, values of the query parameters in MASKED_PARAMS are replaced with MASK
+    void SetUri(std::string_view uri) noexcept;
+
+    std::string_view GetText() const noexcept {
+        return {text.data(), text_size};
+    }
+};
+
+// Single producer, single consumer
+class RingBuffer {
+public:
+    // capacity is rounded up to a power of two
+    explicit RingBuffer(size_t capacity);
+
+    bool TryPush(const Record & record) noexcept;
+
+    // Calls fn for every record pushed so far, returns their number
+    template <typename Fn>
+    size_t Drain(Fn && fn) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+
+        for (size_t i = tail; i != head; ++i) {
+            fn(slots_[i & mask_]);
+        }
+
+        tail_.store(head, std::memory_order_release);
+
+        return head - tail;
+    }
+
+private:
+    std::vector<Record> slots_;
+    size_t mask_;
+
+    alignas(64) std::atomic<size_t> head_ = 0;
+    alignas(64) std::atomic<size_t> tail_ = 0;
+};
+
+class Logger {
+public:
+    struct Config {
+        int fd = 1;
+        // Records per IO thread
+        size_t buffer_size = 4096;
+        // One of sample_rate requests is logged with its response, errors are always logged
+        unsigned sample_rate = 1;
+        std::chrono::milliseconds flush_interval{20};
+        // A batch this large is written without waiting for the interval
+        size_t batch_size = 64 * 1024;
+    };
+
+    static Logger & Instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    Logger(const Logger &) = delete;
+    Logger & operator=(const Logger &) = delete;
+
+    ~Logger();
+
+    // Nothing is logged before Start
+    void Start(Config config);
+
+    // Writes the records logged so far and stops the writer thread
+    void Stop();
+
+    // Called once per request, the response of a sampled request is logged as well
+    bool SampleRequest() noexcept;
+
+    void LogRequest(const net::ip::address & ip, std::string_view uri, http::verb method) noexcept;
+    void LogResponse(int code, std::chrono::milliseconds response_time, std::string_view content_type) noexcept;
+    void LogError(const sys::error_code & ec, const char * where) noexcept;
+
+    // Formats a record as it is written, without the line break
+    static void Format(const Record & record, std::string & out);
+
+private:
+    Logger();
+
+    void Push(const Record & record) noexcept;
+    RingBuffer * GetThreadBuffer() noexcept;
+
+    void Run(std::stop_token stop_token);
+    void Drain();
+    void Write();
+
+    Config config_;
+    std::atomic<bool> started_ = false;
+    std::atomic<unsigned> sample_rate_ = 1;
+
+    std::mutex buffers_mutex_;
+    std::vector<std::shared_ptr<RingBuffer>> buffers_;
+
+    metrics::Counter & dropped_;
+
+//  *   Used by the writer thread only
+    std::string batch_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable_any wake_cv_;
+    std::jthread thread_;
+};
+
+} // namespace access_log
@@ -1,277 +1,501 @@
-#pragma once
-
-#include <cstring>
-#include <chrono>
-#include <iostream>
-#include <random>
-#include <sstream>
-#include <memory>
-#include <vector>
-
-#include <boost/signals2.hpp>
-
-#include "model.h"
-
-namespace sig = boost::signals2;
-
-namespace app {
-
-using namespace std::chrono_literals;
-
-class Application {
-public:
-    using TickHandler = sig::signal<void(std::chrono::milliseconds)>;
-
-    [[nodiscard]] sig::connection DoOnTick(const TickHandler::slot_type & handler) {
-        return tick_signal_.connect(handler);
-    }
-
-    void Tick(std::chrono::milliseconds delta_time) {
-        tick_signal_(delta_time);
-    }
-private:
-    TickHandler tick_signal_;
-};
-
-class Player {
-public:
-    Player (const std::string & token, int player_id, const std::string & player_name, unsigned int session_id) : token_(token), player_id_(player_id), player_name_(player_name), session_id_(session_id) {}
-
-    std::string GetToken() {
-        return token_;
-    }
-
-    std::string GetToken() const {
-        return token_;
-    }
-
-    int GetPlayerId() {
-        return player_id_;
-    }
-
-    int GetPlayerId() const {
-        return player_id_;
-    }
-
-    std::string GetPlayerName() {
-        return player_name_;
-    }
-
-    std::string GetPlayerName() const {
-        return player_name_;
-    }
-
-    unsigned int GetSessionId() const {
-        return session_id_;
-    }
-
-    unsigned int GetScores() noexcept {
-        return scores_;
-    }
-
-    unsigned int GetScores() const noexcept {
-        return scores_;
-    }
-
-    void AddScores(unsigned int scores) {
-        scores_ += scores;
-    }
-
-    std::chrono::duration<double> GetPlayingTime() {
-        return playing_time_;
-    }
-
-    void AddPlayingTime(std::chrono::duration<double> time) {
-        playing_time_ += time;
-    }
-
-    std::chrono::duration<double> GetIdleTime() {
-        return idle_time_;
-    }
-
-    void AddIdleTime(std::chrono::duration<double> time) {
-        idle_time_ += time;
-    }
-
-    void ResetIdleTime() {
-        idle_time_ = 0.0s;
-    }
-
-private:
-    std::string token_;
-    int player_id_;
-    std::string player_name_;
-    unsigned int session_id_;
-
-    unsigned int scores_ = 0;
-
-    std::chrono::duration<double> playing_time_ = 0.0s;
-    std::chrono::duration<double> idle_time_ = 0.0s;
-};
-
-class PlayerTokens {
-public:
-    static PlayerTokens & Instance() {
-
-        static PlayerTokens pt;
-
-        return pt;
-    }
-
-    std::string GetToken() {
-        std::stringstream ss;
-        std::stringstream half_hex_string;
-
-        auto gen1 = generator1_();
-        auto gen2 = generator2_();
-
-        half_hex_string << std::hex << gen1;
-
-        if (half_hex_string.str().size() < 16) {
-
-            for (int i = 0; i < 16 - half_hex_string.str().size(); ++i) {
-                ss << "0";
-            }
-        }
-
-        ss << half_hex_string.str();
-
-        half_hex_string.str("");
-        half_hex_string << std::hex << gen2;
-
-        if (half_hex_string.str().size() < 16) {
-
-            for (int i = 0; i < 16 - half_hex_string.str().size(); ++i) {
-                ss << "0";
-            }
-        }
-
-        ss << half_hex_string.str();
-
-        return ss.str();
-    }
-
-private:
-    PlayerTokens() {}
-
-    std::random_device random_device_;
-    std::mt19937_64 generator1_{[this] {
-        std::uniform_int_distribution<std::mt19937_64::result_type> dist;
-        return dist(random_device_);
-    }()};
-    std::mt19937_64 generator2_{[this] {
-        std::uniform_int_distribution<std::mt19937_64::result_type> dist;
-        return dist(random_device_);
-    }()};
-}; 
-
-class PlayersManager {
-public:
-    static PlayersManager & Instance() {
-        static PlayersManager pm;
-
-        return pm;
-    }
-
-    Player & AddNewPlayer(const std::string & player_name, model::GameSession * session) {
-        std::string token{PlayerTokens::Instance().GetToken()};
-
-        players_.emplace_back(token, player_id_++, player_name, session->GetId());
-
-        session->NewPlayer(players_.back().GetPlayerId());
-
-        return players_.back();
-    }
-
-    Player * GetPlayerByToken(const std::string & token) {
-        Player * player = 0;
-
-        for (Player & p : players_) {
-            if (std::strcmp(p.GetToken().c_str(), token.c_str()) == 0) {
-                player = &p;
-                break;
-            }
-        }
-
-        return player;
-    }
-
-    Player * GetPlayerById(int id) {
-        Player * player = 0;
-
-        for (Player & p : players_) {
-            if (p.GetPlayerId() == id) {
-                player = &p;
-            }
-        }
-
-        return player;
-    }
-
-    std::vector<Player> & GetPlayers() {
-        return players_;
-    }
-
-    const std::vector<Player> & GetPlayers() const {
-        return players_;
-    }
-
-    int GetNextPlayerId() const {
-        return player_id_;
-    }
-
-    void SetNextPlayerId(int player_id) {
-        player_id_ = player_id;
-    }
-
-    void RemovePlayer(unsigned int id) {
-        for (auto player_it = players_.begin(); player_it != players_.end(); ++player_it) {
-            if (id == player_it->GetPlayerId()) {
-                players_.erase(player_it);
-                break;
-            }
-        }
-    }
-private:
-    PlayersManager() {}
-
-    int player_id_ = 0;
-    std::vector<Player> players_;
-};
-
-struct GameResult {
-public:
-    GameResult (std::string_view name, unsigned int scores, unsigned int session_duration) : name_{name.begin(), name.end()}, scores_{scores}, session_duration_{session_duration} {}
-
-    std::string name_;
-    unsigned int scores_;
-    unsigned int session_duration_;
-};
-
-class IGameResultRepository {
-public:
-    virtual std::vector<GameResult> GetResults(unsigned int offset = 0, unsigned int results_count = max_results_count_) = 0;
-    virtual void AddResult(const app::GameResult & game_result) = 0;
-protected:
-    ~IGameResultRepository() {}
-private:
-    static const unsigned int max_results_count_ = 100;
-};
-
-class IUnitOfWork {
-public:
-    virtual IGameResultRepository * Results() = 0;
-    virtual void Commit() = 0;
-protected:
-    ~IUnitOfWork() {}
-
-};
-
-class IUnitOfWorkFactory {
-public:
-    virtual std::shared_ptr<IUnitOfWork> NewUnitOfWork() = 0; 
-
-protected:
-    ~IUnitOfWorkFactory() {}
-};
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/random.h>
+
+#include <boost/signals2.hpp>
+
+#include "model.h"
+#include "results_cursor.h"
+#include "timer_wheel.h"
+
+namespace sig = boost::signals2;
+
+namespace app {
+
+using namespace std::chrono_literals;
+
+class Application {
+public:
+    using TickHandler = sig::signal<void(std::chrono::milliseconds)>;
+
+    [[nodiscard]] sig::connection DoOnTick(const TickHandler::slot_type & handler) {
+        return tick_signal_.connect(handler);
+    }
+
+// *    A negative delta is taken as zero: the idle dogs wheel counts the game clock in unsigned ticks
+    void Tick(std::chrono::milliseconds delta_time) {
+        delta_time = std::max(delta_time, std::chrono::milliseconds{0});
+        game_time_ += delta_time;
+        tick_signal_(delta_time);
+    }
+
+    std::chrono::milliseconds GetGameTime() const noexcept {
+        return game_time_;
+    }
+
+// *    Restores the game clock of a checkpoint, must be called before any dog is scheduled
+    void SetGameTime(std::chrono::milliseconds game_time) {
+        game_time_ = game_time;
+        idle_dogs_ = IdleDogsWheel{static_cast<IdleDogsWheel::Time>(game_time_.count())};
+    }
+
+    void SetDogIdleTimeThreshold(std::chrono::milliseconds threshold) {
+        dog_idle_time_threshold_ = threshold;
+    }
+
+// *    Idle dogs are kept in a timer wheel keyed by player id with the retirement deadline,
+// *    so a tick only touches the dogs that actually retire
+    void OnDogStopped(int player_id, std::chrono::milliseconds since) {
+        idle_dogs_.Schedule(player_id, static_cast<IdleDogsWheel::Time>((since + dog_idle_time_threshold_).count()));
+    }
+
+    void OnDogStopped(int player_id) {
+        OnDogStopped(player_id, game_time_);
+    }
+
+    void OnDogMoved(int player_id) {
+        idle_dogs_.Cancel(player_id);
+    }
+
+// *    Applies a move command of the player, the live request and the journal replay share it
+    void MoveDog(model::GameSession & session, model::Dog & dog, model::Direction dir) {
+        model::Vector2 prev_speed = dog.GetSpeed();
+        double speed = session.GetMap()->GetDogSpeed();
+
+        if (dir == model::Direction::NORTH) {
+            dog.SetSpeed(model::Vector2{0, -speed});
+        } else if (dir == model::Direction::EAST) {
+            dog.SetSpeed(model::Vector2{speed, 0});
+        } else if (dir == model::Direction::SOUTH) {
+            dog.SetSpeed(model::Vector2{0, speed});
+        } else if (dir == model::Direction::WEST) {
+            dog.SetSpeed(model::Vector2{-speed, 0});
+        } else {
+            dog.SetSpeed(model::Vector2{0, 0});
+        }
+
+        if (dir != model::Direction::ZERO) {
+            dog.SetDirection(dir);
+        }
+
+        if (dog.GetSpeed() != model::Vector2{0, 0}) {
+            OnDogMoved(dog.GetId());
+        } else if (prev_speed != model::Vector2{0, 0}) {
+            OnDogStopped(dog.GetId());
+        }
+    }
+
+    template <typename Fn>
+    void ForEachRetiredDog(Fn && fn) {
+        idle_dogs_.Advance(static_cast<IdleDogsWheel::Time>(game_time_.count()), std::forward<Fn>(fn));
+    }
+private:
+    using IdleDogsWheel = timer_wheel::HierarchicalTimerWheel<int>;
+
+    TickHandler tick_signal_;
+
+    std::chrono::milliseconds game_time_{0};
+    std::chrono::milliseconds dog_idle_time_threshold_{1000};
+    IdleDogsWheel idle_dogs_;
+};
+
+static constexpr size_t TOKEN_SIZE = 32;
+
+using Token = std::array<char, TOKEN_SIZE>;
+
+inline std::string_view TokenView(const Token & token) noexcept {
+    return {token.data(), token.size()};
+}
+
+inline Token ParseToken(std::string_view str) {
+    if (str.size() != TOKEN_SIZE) {
+        throw std::invalid_argument("Parse error: invalid token size");
+    }
+
+    Token token;
+    std::copy(str.begin(), str.end(), token.begin());
+
+    return token;
+}
+
+class Player {
+public:
+    Player (const Token & token, int player_id, const std::string & player_name, unsigned int session_id, std::chrono::milliseconds join_time = 0ms) : token_(token), player_id_(player_id), player_name_(player_name), session_id_(session_id), join_time_(join_time) {}
+
+    std::string_view GetToken() const noexcept {
+        return TokenView(token_);
+    }
+
+    int GetPlayerId() {
+        return player_id_;
+    }
+
+    int GetPlayerId() const {
+        return player_id_;
+    }
+
+    std::string GetPlayerName() {
+        return player_name_;
+    }
+
+    std::string GetPlayerName() const {
+        return player_name_;
+    }
+
+    unsigned int GetSessionId() const {
+        return session_id_;
+    }
+
+    unsigned int GetScores() noexcept {
+        return scores_.load(std::memory_order_relaxed);
+    }
+
+    unsigned int GetScores() const noexcept {
+        return scores_.load(std::memory_order_relaxed);
+    }
+
+    void AddScores(unsigned int scores) {
+        scores_.fetch_add(scores, std::memory_order_relaxed);
+    }
+
+    std::chrono::milliseconds GetJoinTime() const noexcept {
+        return join_time_;
+    }
+
+    std::chrono::duration<double> GetPlayingTime(std::chrono::milliseconds now) const {
+        return now - join_time_;
+    }
+
+private:
+    Token token_;
+    int player_id_;
+    std::string player_name_;
+    unsigned int session_id_;
+
+    std::atomic<unsigned int> scores_ = 0;
+
+    std::chrono::milliseconds join_time_;
+};
+
+// Tokens are 128 bits of kernel CSPRNG output written as 32 lowercase hex digits.
+// Every thread keeps its own buffer of random bytes, so a token costs no lock and
+// no allocation; the buffer is refilled by one getrandom(2) call per 256 tokens.
+class PlayerTokens {
+public:
+    static Token GetToken() {
+        thread_local RandomPool pool;
+
+        std::array<std::uint8_t, TOKEN_SIZE / 2> bytes;
+        pool.Take(bytes.data(), bytes.size());
+
+        Token token;
+        for (size_t i = 0; i < bytes.size(); ++i) {
+            token[2 * i] = HEX_PAIRS[2 * bytes[i]];
+            token[2 * i + 1] = HEX_PAIRS[2 * bytes[i] + 1];
+        }
+
+        return token;
+    }
+
+private:
+    PlayerTokens() = delete;
+
+    static constexpr std::array<char, 512> HEX_PAIRS = [] {
+        constexpr char digits[] = "0123456789abcdef";
+        std::array<char, 512> pairs{};
+
+        for (size_t byte = 0; byte < 256; ++byte) {
+            pairs[2 * byte] = digits[byte >> 4];
+            pairs[2 * byte + 1] = digits[byte & 0x0f];
+        }
+
+        return pairs;
+    }();
+
+    class RandomPool {
+    public:
+        void Take(std::uint8_t * out, size_t count) {
+            if (pos_ + count > buffer_.size()) {
+                Refill();
+            }
+
+            std::memcpy(out, buffer_.data() + pos_, count);
+            pos_ += count;
+        }
+
+    private:
+        void Refill() {
+            size_t filled = 0;
+
+            while (filled < buffer_.size()) {
+                ssize_t res = getrandom(buffer_.data() + filled, buffer_.size() - filled, 0);
+
+                if (res < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    throw std::system_error(errno, std::generic_category(), "getrandom");
+                }
+
+                filled += static_cast<size_t>(res);
+            }
+
+            pos_ = 0;
+        }
+
+        std::array<std::uint8_t, 4096> buffer_;
+        size_t pos_ = buffer_.size();
+    };
+};
+
+// Process-wide registry of players that is safe to read from any IO thread.
+// Players are sharded by token hash (and indexed by id in a second set of shards);
+// every shard is guarded by its own shared mutex, so lookups only contend with
+// joins and retirements that hash into the same shard. Players are handed out as
+// shared pointers, so a reader keeps its player alive even if it retires meanwhile.
+class PlayersManager {
+public:
+    using PlayerPtr = std::shared_ptr<Player>;
+
+    static constexpr size_t SHARDS_COUNT = 16;
+
+    static PlayersManager & Instance() {
+        static PlayersManager pm;
+
+        return pm;
+    }
+
+    PlayerPtr AddNewPlayer(const std::string & player_name, model::GameSession * session, std::chrono::milliseconds join_time = 0ms) {
+        PlayerPtr player = std::make_shared<Player>(PlayerTokens::GetToken(), player_id_.fetch_add(1), player_name, session->GetId(), join_time);
+
+        session->NewPlayer(player->GetPlayerId());
+        AddPlayer(player);
+
+        return player;
+    }
+
+    void AddPlayer(PlayerPtr player) {
+        Token token = ParseToken(player->GetToken());
+
+        {
+            TokenShard & shard = token_shards_[TokenShardIndex(token)];
+            std::unique_lock lock{shard.mutex};
+            shard.players.insert_or_assign(token, player);
+        }
+
+        {
+            IdShard & shard = id_shards_[IdShardIndex(player->GetPlayerId())];
+            std::unique_lock lock{shard.mutex};
+            shard.players.insert_or_assign(player->GetPlayerId(), std::move(player));
+        }
+    }
+
+    PlayerPtr GetPlayerByToken(std::string_view token_str) const {
+        if (token_str.size() != TOKEN_SIZE) {
+            return nullptr;
+        }
+
+        Token token = ParseToken(token_str);
+
+        const TokenShard & shard = token_shards_[TokenShardIndex(token)];
+        std::shared_lock lock{shard.mutex};
+
+        auto it = shard.players.find(token);
+
+        return it != shard.players.end() ? it->second : nullptr;
+    }
+
+    PlayerPtr GetPlayerById(int id) const {
+        const IdShard & shard = id_shards_[IdShardIndex(id)];
+        std::shared_lock lock{shard.mutex};
+
+        auto it = shard.players.find(id);
+
+        return it != shard.players.end() ? it->second : nullptr;
+    }
+
+    template <typename Fn>
+    void ForEachPlayer(Fn && fn) const {
+        for (const IdShard & shard : id_shards_) {
+            std::shared_lock lock{shard.mutex};
+
+            for (const auto & [id, player] : shard.players) {
+                fn(*player);
+            }
+        }
+    }
+
+    std::vector<PlayerPtr> GetPlayers() const {
+        std::vector<PlayerPtr> players;
+
+        for (const IdShard & shard : id_shards_) {
+            std::shared_lock lock{shard.mutex};
+
+            for (const auto & [id, player] : shard.players) {
+                players.emplace_back(player);
+            }
+        }
+
+        return players;
+    }
+
+    int GetNextPlayerId() const {
+        return player_id_.load();
+    }
+
+    void SetNextPlayerId(int player_id) {
+        player_id_.store(player_id);
+    }
+
+    void RemovePlayer(int id) {
+        PlayerPtr player;
+
+        {
+            IdShard & shard = id_shards_[IdShardIndex(id)];
+            std::unique_lock lock{shard.mutex};
+
+            auto it = shard.players.find(id);
+            if (it == shard.players.end()) {
+                return;
+            }
+
+            player = std::move(it->second);
+            shard.players.erase(it);
+        }
+
+        Token token = ParseToken(player->GetToken());
+
+        TokenShard & shard = token_shards_[TokenShardIndex(token)];
+        std::unique_lock lock{shard.mutex};
+        shard.players.erase(token);
+    }
+
+    // Drops every player and restarts the ids, used when a partly restored save is discarded
+    void Clear() {
+        for (TokenShard & shard : token_shards_) {
+            std::unique_lock lock{shard.mutex};
+            shard.players.clear();
+        }
+
+        for (IdShard & shard : id_shards_) {
+            std::unique_lock lock{shard.mutex};
+            shard.players.clear();
+        }
+
+        player_id_.store(0);
+    }
+private:
+    struct TokenHasher {
+        size_t operator()(const Token & token) const noexcept {
+            return std::hash<std::string_view>{}(TokenView(token));
+        }
+    };
+
+    struct TokenShard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<Token, PlayerPtr, TokenHasher> players;
+    };
+
+    struct IdShard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<int, PlayerPtr> players;
+    };
+
+    PlayersManager() {}
+
+    static size_t TokenShardIndex(const Token & token) noexcept {
+        return TokenHasher{}(token) % SHARDS_COUNT;
+    }
+
+    static size_t IdShardIndex(int id) noexcept {
+        return static_cast<unsigned int>(id) % SHARDS_COUNT;
+    }
+
+    std::atomic<int> player_id_ = 0;
+    std::array<TokenShard, SHARDS_COUNT> token_shards_;
+    std::array<IdShard, SHARDS_COUNT> id_shards_;
+};
+
+struct GameResult {
+public:
+    GameResult (std::string_view name, unsigned int scores, unsigned int session_duration, std::uint64_t id = 0) : name_{name.begin(), name.end()}, scores_{scores}, session_duration_{session_duration}, id_{id} {}
+
+    std::string name_;
+    unsigned int scores_;
+    unsigned int session_duration_;
+//  *   Assigned by the server when the player retires, unique among the results
+    std::uint64_t id_;
+};
+
+// Records order: scores DESC, playTime ASC, name ASC, id ASC.
+// Names are compared bytewise, the database sorts them with the "C" collation to match.
+struct GameResultOrder {
+    bool operator()(const GameResult & lhs, const GameResult & rhs) const {
+        if (lhs.scores_ != rhs.scores_) {
+            return lhs.scores_ > rhs.scores_;
+        }
+        if (lhs.session_duration_ != rhs.session_duration_) {
+            return lhs.session_duration_ < rhs.session_duration_;
+        }
+        if (int compare = lhs.name_.compare(rhs.name_); compare != 0) {
+            return compare < 0;
+        }
+        return lhs.id_ < rhs.id_;
+    }
+};
+
+class IGameResultRepository {
+public:
+    virtual std::vector<GameResult> GetResults(unsigned int offset = 0, unsigned int results_count = max_results_count_) = 0;
+    virtual std::vector<GameResult> GetResultsAfter(const ResultsCursor & cursor, unsigned int results_count = max_results_count_) = 0;
+    // The largest id among the stored results, 0 when there are none
+    virtual std::uint64_t GetLastResultId() = 0;
+    virtual void AddResult(const app::GameResult & game_result) = 0;
+    virtual void AddResults(const std::vector<app::GameResult> & game_results) = 0;
+protected:
+    ~IGameResultRepository() {}
+private:
+    static const unsigned int max_results_count_ = 100;
+};
+
+// Thrown when the storage can't serve a request right now, the request may be retried later
+class StorageUnavailableError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+class IUnitOfWork {
+public:
+    virtual IGameResultRepository * Results() = 0;
+    virtual void Commit() = 0;
+protected:
+    ~IUnitOfWork() {}
+
+};
+
+class IUnitOfWorkFactory {
+public:
+    virtual std::shared_ptr<IUnitOfWork> NewUnitOfWork() = 0; 
+
+protected:
+    ~IUnitOfWorkFactory() {}
+};
 } //namespace app
\ No newline at end of file
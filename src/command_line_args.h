@@ -1,15 +1,36 @@
-#pragma once
-
-#include <optional>
-
-struct Args {
-
-    int tick_period;
-    int autosave_period = -1;
-    std::string config_file;
-    std::string wwwroot_dir;
-    std::string save_file_path;
-    bool random_position;
-    bool no_tick_period;
-
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+struct Args {
+
+    int tick_period;
+    int autosave_period = -1;
+    std::string config_file;
+    std::string wwwroot_dir;
+    std::string save_file_path;
+    bool save_compress = false;
+    std::string save_fsync = "full";
+    unsigned int save_generations = 1;
+    std::uint64_t save_dirty_threshold = 0;
+    bool random_position;
+    bool no_tick_period;
+    unsigned int db_pool_size = 4;
+    unsigned int db_connect_threads = 1;
+    int db_acquire_timeout = 200;
+    bool db_lazy_connect = false;
+    std::string db_schema = "plain";
+    unsigned int db_top_results = 1000;
+    std::string results_store_path;
+    std::string journal_path;
+    int journal_commit_interval = 20;
+    unsigned int log_sample_rate = 1;
+    size_t log_buffer_size = 4096;
+    int keep_alive_timeout = 15000;
+    std::uint64_t keep_alive_max_requests = 0;
+    bool io_per_core = false;
+    bool pin_threads = false;
+    std::uint64_t static_cache_size = 256;
+
 };
\ No newline at end of file
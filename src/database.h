@@ -1,161 +1,495 @@
-#pragma once
-
-#include <memory>
-#include <mutex>
-#include <condition_variable>
-
-#include <pqxx/pqxx>
-
-#include "app.h"
-
-namespace database {
-
-using pqxx::operator""_zv;
-
-static constexpr auto SELECT_RESULTS_TAG = "select_result"_zv;
-static constexpr auto INSERT_RESULT_TAG = "insert_result"_zv;
-
-class ConnectionPool {
-public:
-    class ConnectionHolder {
-    public:
-        explicit ConnectionHolder(std::shared_ptr<pqxx::connection> conn, ConnectionPool & pool) : conn_{conn}, pool_{&pool} {}
-
-        ConnectionHolder(const ConnectionHolder&) = delete;
-        ConnectionHolder& operator=(const ConnectionHolder&) = delete;
-
-        ConnectionHolder(ConnectionHolder&&) = default;
-        ConnectionHolder& operator=(ConnectionHolder&&) = default;
-
-        pqxx::connection& operator*() const& noexcept {
-            return *conn_;
-        }
-        pqxx::connection& operator*() const&& = delete;
-
-        pqxx::connection* operator->() const& noexcept {
-            return conn_.get();
-        }
-
-        ~ConnectionHolder() {
-            if (conn_) {
-                pool_->ReturnConnection(std::move(*conn_));
-            }
-        }
-    private:
-        std::shared_ptr<pqxx::connection> conn_;
-        ConnectionPool * pool_;
-    };
-
-    ConnectionPool(unsigned int size, std::string_view connection_string) {
-        connections_.reserve(size);
-
-        for (int conn_idx = 0; conn_idx < size; ++conn_idx) {
-            connections_.emplace_back(connection_string.data());
-
-            if (conn_idx == 0) {
-                pqxx::work w(connections_.back());
-
-                w.exec("CREATE TABLE IF NOT EXISTS retired_players(name TEXT NOT NULL, scores INTEGER DEFAULT(0), playTime INTEGER NOT NULL);"_zv);
-                w.exec("CREATE INDEX IF NOT EXISTS top_retired_players_index ON retired_players(scores DESC, playTime ASC, name ASC);"_zv);
-
-                w.commit();
-            }
-
-            connections_.back().prepare(SELECT_RESULTS_TAG, "SELECT name, scores, playTime FROM retired_players ORDER BY scores DESC, playTime ASC, name ASC LIMIT $1 OFFSET $2;"_zv);
-            connections_.back().prepare(INSERT_RESULT_TAG, "INSERT INTO retired_players(name, scores, playTime) VALUES($1, $2, $3);"_zv);
-        }
-    }
-
-    ConnectionHolder GetConnection() {
-        std::unique_lock lock{m_};
-
-        cv_.wait(lock, [this] {
-            return using_connections_ < connections_.size();
-        });
-
-        ConnectionHolder conn_holder = ConnectionHolder(std::make_shared<pqxx::connection>(std::move(connections_.back())), *this);
-        connections_.pop_back();
-        ++using_connections_;
-
-        return conn_holder;
-    }
-
-private:
-    void ReturnConnection(pqxx::connection && conn) {
-        std::unique_lock lock{m_};
-
-        --using_connections_;
-        connections_.emplace_back(std::move(conn));
-
-        cv_.notify_one();
-    }
-
-    std::mutex m_;
-    std::condition_variable cv_;
-    std::vector<pqxx::connection> connections_;
-    unsigned int using_connections_ = 0;
-};
-
-class GameResultRepository : public app::IGameResultRepository {
-public:
-    explicit GameResultRepository(pqxx::work & work) : work_{work} {}
-
-    std::vector<app::GameResult> GetResults(unsigned int results_count = max_results_count_, unsigned int offset = 0) override {
-        std::vector<app::GameResult> results;
-        results.reserve(results_count);
-
-        pqxx::result result = work_.exec_prepared(SELECT_RESULTS_TAG, results_count, offset);
-
-        for (auto row = result.begin(); row != result.end(); ++row) {
-            std::string name = row->at(0).as<std::string>();
-            unsigned int scores = row->at(1).as<unsigned int>();
-            unsigned int session_duration = row->at(2).as<unsigned int>();
-            results.emplace_back(name, scores, session_duration);
-        }
-
-        return results;
-    }
-    void AddResult(const app::GameResult & game_result) override {
-        work_.exec_prepared(INSERT_RESULT_TAG, game_result.name_, game_result.scores_, game_result.session_duration_);
-    }
-private:
-    static const unsigned int max_results_count_ = 100;
-
-    pqxx::work & work_;
-};
-
-class DbUnitOfWork : public app::IUnitOfWork {
-public:
-    using ConnectionHolder = ConnectionPool::ConnectionHolder;
-
-    explicit DbUnitOfWork(ConnectionHolder && conn) : conn_{std::move(conn)}, work_{*conn_}, game_result_repos_{work_} {}
-
-    ~DbUnitOfWork() {
-        Commit();
-    }
-
-    app::IGameResultRepository * Results() override {
-        return &game_result_repos_;
-    }
-
-    void Commit() override {
-        work_.commit();
-    }
-private:
-    ConnectionHolder conn_;
-    pqxx::work work_;
-    GameResultRepository game_result_repos_;
-};
-
-class DbUnitOfWorkFactory : public app::IUnitOfWorkFactory {
-public:
-    explicit DbUnitOfWorkFactory(std::shared_ptr<ConnectionPool> pool) : pool_{pool} {}
-
-    std::shared_ptr<app::IUnitOfWork> NewUnitOfWork() override {
-        return std::make_shared<DbUnitOfWork>(std::move(pool_->GetConnection()));
-    }
-private:
-    std::shared_ptr<ConnectionPool> pool_;
-};
-
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pqxx/pqxx>
+
+#include "app.h"
+#include "logger.h"
+#include "metrics.h"
+
+namespace database {
+
+using pqxx::operator""_zv;
+
+static constexpr auto SELECT_RESULTS_TAG = "select_result"_zv;
+static constexpr auto SELECT_RESULTS_AFTER_TAG = "select_result_after"_zv;
+static constexpr auto INSERT_RESULT_TAG = "insert_result"_zv;
+static constexpr auto SELECT_LAST_RESULT_ID_TAG = "select_last_result_id"_zv;
+static constexpr auto SELECT_TOP_RESULTS_TAG = "select_top_result"_zv;
+static constexpr auto SELECT_TOP_RESULTS_AFTER_TAG = "select_top_result_after"_zv;
+static constexpr auto INSERT_TOP_RESULT_TAG = "insert_top_result"_zv;
+static constexpr auto TRIM_TOP_RESULTS_TAG = "trim_top_results"_zv;
+
+enum class SchemaMode {
+//  *   One retired_players table
+    plain,
+//  *   retired_players partitioned by retirement month, plus a top_results table with the best rows
+    partitioned
+};
+
+class ConnectionPool {
+public:
+    static constexpr std::chrono::hours PARTITIONS_CHECK_INTERVAL{1};
+
+    struct Config {
+        unsigned int size = 4;
+//  *   Connections opened simultaneously at startup
+        unsigned int connect_threads = 1;
+//  *   How long a checkout may wait for a free connection before giving up
+        std::chrono::milliseconds acquire_timeout{200};
+//  *   Open connections on demand instead of at startup
+        bool lazy_connect = false;
+        SchemaMode schema_mode = SchemaMode::plain;
+//  *   Rows kept in top_results in the partitioned mode
+        unsigned int top_results_size = 1000;
+    };
+
+    class ConnectionHolder {
+    public:
+        explicit ConnectionHolder(std::unique_ptr<pqxx::connection> conn, ConnectionPool & pool) : conn_{std::move(conn)}, pool_{&pool} {}
+
+        ConnectionHolder(const ConnectionHolder&) = delete;
+        ConnectionHolder& operator=(const ConnectionHolder&) = delete;
+
+        ConnectionHolder(ConnectionHolder&&) = default;
+        ConnectionHolder& operator=(ConnectionHolder&&) = default;
+
+        pqxx::connection& operator*() const& noexcept {
+            return *conn_;
+        }
+        pqxx::connection& operator*() const&& = delete;
+
+        pqxx::connection* operator->() const& noexcept {
+            return conn_.get();
+        }
+
+        ~ConnectionHolder() {
+            if (conn_) {
+                pool_->ReturnConnection(std::move(conn_));
+            }
+        }
+    private:
+        std::unique_ptr<pqxx::connection> conn_;
+        ConnectionPool * pool_;
+    };
+
+    ConnectionPool(unsigned int size, std::string_view connection_string) : ConnectionPool(Config{.size = size}, connection_string) {}
+
+    ConnectionPool(Config config, std::string_view connection_string)
+        : config_{config}
+        , connection_string_{connection_string}
+        , checkouts_{metrics::Registry::Instance().GetCounter("db_pool_checkouts_total")}
+        , exhausted_{metrics::Registry::Instance().GetCounter("db_pool_exhausted_total")}
+        , in_use_{metrics::Registry::Instance().GetGauge("db_pool_in_use")}
+        , open_{metrics::Registry::Instance().GetGauge("db_pool_connections_open")}
+        , wait_time_{metrics::Registry::Instance().GetTiming("db_pool_wait_seconds")} {
+        config_.size = std::max(config_.size, 1u);
+        metrics::Registry::Instance().GetGauge("db_pool_size").Set(config_.size);
+
+        idle_.reserve(config_.size);
+
+//  *   The first connection also creates the schema, so it is always opened eagerly
+        {
+            std::unique_ptr<pqxx::connection> conn = std::make_unique<pqxx::connection>(connection_string_);
+            pqxx::work w(*conn);
+
+            if (config_.schema_mode == SchemaMode::partitioned) {
+                CreatePartitionedSchema(w);
+            } else {
+                w.exec("CREATE TABLE IF NOT EXISTS retired_players(id BIGSERIAL, name TEXT NOT NULL, scores INTEGER DEFAULT(0), playTime INTEGER NOT NULL);"_zv);
+            }
+
+            CreateRecordsIndexes(w);
+
+            if (partitioned_) {
+                CreateMonthPartitions(w);
+            }
+
+            w.commit();
+
+            Prepare(*conn);
+            idle_.emplace_back(std::move(conn));
+            ++opened_;
+            open_.Add();
+        }
+
+        if (!config_.lazy_connect) {
+            OpenConnections(config_.size - 1);
+        }
+
+        if (partitioned_) {
+            partitions_maintainer_ = std::jthread([this] (std::stop_token stop_token) {
+                MaintainPartitions(stop_token);
+            });
+        }
+    }
+
+    // Waits up to acquire_timeout for a free connection. Called on the DB executor and the results writer threads,
+    // never on an IO thread.
+    ConnectionHolder GetConnection() {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        std::unique_lock lock{m_};
+
+        if (!cv_.wait_for(lock, config_.acquire_timeout, [this] {
+            return !idle_.empty() || opened_ < config_.size;
+        })) {
+            lock.unlock();
+            exhausted_.Increment();
+            throw app::StorageUnavailableError("Database connection pool is exhausted");
+        }
+
+        std::unique_ptr<pqxx::connection> conn;
+
+        if (!idle_.empty()) {
+            conn = std::move(idle_.back());
+            idle_.pop_back();
+            lock.unlock();
+        } else {
+//  *   Lazy connect: the slot is reserved under the lock, the connection is opened outside of it
+            ++opened_;
+            lock.unlock();
+
+            try {
+                conn = Connect();
+            } catch (...) {
+                lock.lock();
+                --opened_;
+                cv_.notify_one();
+                throw;
+            }
+
+            open_.Add();
+        }
+
+        wait_time_.Observe(std::chrono::steady_clock::now() - start);
+        checkouts_.Increment();
+        in_use_.Add();
+
+        return ConnectionHolder(std::move(conn), *this);
+    }
+
+    // 0 when there is no top_results table
+    unsigned int GetTopResultsSize() const noexcept {
+        return config_.schema_mode == SchemaMode::partitioned ? config_.top_results_size : 0;
+    }
+
+private:
+    // Partitions hold a month of retirements each. The current and the next one are created at start
+    // and checked every PARTITIONS_CHECK_INTERVAL, so a retirement lands in the default partition only
+    // when the server was down over a month boundary.
+    // An existing unpartitioned retired_players is kept as it is, it gets no partitions.
+    void CreatePartitionedSchema(pqxx::work & w) {
+        w.exec("CREATE TABLE IF NOT EXISTS retired_players(id BIGSERIAL, name TEXT NOT NULL, scores INTEGER DEFAULT(0), playTime INTEGER NOT NULL, retired_at TIMESTAMPTZ NOT NULL DEFAULT now()) PARTITION BY RANGE (retired_at);"_zv);
+
+        partitioned_ = w.query_value<bool>("SELECT EXISTS (SELECT 1 FROM pg_partitioned_table WHERE partrelid = 'retired_players'::regclass);"_zv);
+
+        if (partitioned_) {
+            w.exec("CREATE TABLE IF NOT EXISTS retired_players_default PARTITION OF retired_players DEFAULT;"_zv);
+        }
+    }
+
+//  *   A missing partition is created detached, the rows of its month are moved into it from the default partition,
+//  *   and then it is attached: creating it right away fails when the default partition holds such rows.
+//  *   Any failure aborts the transaction and is reported by the caller.
+    void CreateMonthPartitions(pqxx::work & w) const {
+        w.exec(R"(DO $$
+DECLARE
+    month_start DATE;
+    month_end DATE;
+    partition_name TEXT;
+BEGIN
+    FOR i IN 0..1 LOOP
+        month_start := (date_trunc('month', now()) + make_interval(months => i))::DATE;
+        month_end := (month_start + INTERVAL '1 month')::DATE;
+        partition_name := 'retired_players_' || to_char(month_start, 'YYYY_MM');
+
+        CONTINUE WHEN to_regclass(partition_name) IS NOT NULL;
+
+        EXECUTE format('CREATE TABLE %I (LIKE retired_players INCLUDING DEFAULTS)', partition_name);
+        EXECUTE format('WITH moved AS (DELETE FROM retired_players_default WHERE retired_at >= %L AND retired_at < %L RETURNING id, name, scores, playTime, retired_at) '
+            'INSERT INTO %I(id, name, scores, playTime, retired_at) SELECT id, name, scores, playTime, retired_at FROM moved',
+            month_start, month_end, partition_name);
+        EXECUTE format('ALTER TABLE retired_players ATTACH PARTITION %I FOR VALUES FROM (%L) TO (%L)', partition_name, month_start, month_end);
+    END LOOP;
+END $$;)"_zv);
+    }
+
+    void MaintainPartitions(std::stop_token stop_token) {
+        std::mutex m;
+        std::condition_variable_any cv;
+
+        while (true) {
+            {
+                std::unique_lock lock{m};
+                cv.wait_for(lock, stop_token, PARTITIONS_CHECK_INTERVAL, [] {
+                    return false;
+                });
+            }
+
+            if (stop_token.stop_requested()) {
+                return;
+            }
+
+            try {
+                ConnectionHolder conn = GetConnection();
+                pqxx::work w(*conn);
+                CreateMonthPartitions(w);
+                w.commit();
+            } catch (const std::exception & ex) {
+                BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{"exception", ex.what()}, {"where", "partitions"}}) << logging::add_value(message_, "error");
+            }
+        }
+    }
+
+    // The records order (scores DESC, playTime ASC, name ASC, id ASC) compares names bytewise like the server does.
+    // Ids are assigned by the server, BIGSERIAL only numbers the rows of a table created before the column.
+    void CreateRecordsIndexes(pqxx::work & w) const {
+        w.exec("ALTER TABLE retired_players ADD COLUMN IF NOT EXISTS id BIGSERIAL;"_zv);
+        w.exec("DROP INDEX IF EXISTS top_retired_players_index;"_zv);
+        w.exec(R"(CREATE INDEX IF NOT EXISTS retired_players_records_index ON retired_players(scores DESC, playTime ASC, name COLLATE "C" ASC, id ASC);)"_zv);
+        w.exec("CREATE INDEX IF NOT EXISTS retired_players_id_index ON retired_players(id);"_zv);
+
+        if (config_.schema_mode != SchemaMode::partitioned) {
+            return;
+        }
+
+//  *   The table is rebuilt on every start: top_results_size may have changed, and results written
+//  *   in the plain mode meanwhile never reached it. The records index makes the top-N read cheap.
+        w.exec("CREATE TABLE IF NOT EXISTS top_results(id BIGINT NOT NULL, name TEXT NOT NULL, scores INTEGER NOT NULL, playTime INTEGER NOT NULL);"_zv);
+        w.exec("ALTER TABLE top_results ADD COLUMN IF NOT EXISTS id BIGINT;"_zv);
+        w.exec("DROP INDEX IF EXISTS top_results_index;"_zv);
+        w.exec(R"(CREATE INDEX IF NOT EXISTS top_results_records_index ON top_results(scores DESC, playTime ASC, name COLLATE "C" ASC, id ASC);)"_zv);
+        w.exec("TRUNCATE top_results;"_zv);
+        w.exec_params(R"(INSERT INTO top_results(id, name, scores, playTime) SELECT id, name, scores, playTime FROM retired_players ORDER BY scores DESC, playTime ASC, name COLLATE "C" ASC, id ASC LIMIT $1;)"_zv, config_.top_results_size);
+    }
+
+    std::unique_ptr<pqxx::connection> Connect() const {
+        std::unique_ptr<pqxx::connection> conn = std::make_unique<pqxx::connection>(connection_string_);
+        Prepare(*conn);
+
+        return conn;
+    }
+
+    void Prepare(pqxx::connection & conn) const {
+        conn.prepare(SELECT_RESULTS_TAG, R"(SELECT id, name, scores, playTime FROM retired_players ORDER BY scores DESC, playTime ASC, name COLLATE "C" ASC, id ASC LIMIT $1 OFFSET $2;)"_zv);
+//  *   Keyset page: "scores <= $1" positions the retired_players_records_index scan at the cursor score,
+//  *   the rest skips only the rows sharing that score
+        conn.prepare(SELECT_RESULTS_AFTER_TAG, R"(SELECT id, name, scores, playTime FROM retired_players WHERE scores <= $1 AND (scores < $1 OR (playTime, name COLLATE "C", id) > ($2, $3, $4)) ORDER BY scores DESC, playTime ASC, name COLLATE "C" ASC, id ASC LIMIT $5;)"_zv);
+        conn.prepare(INSERT_RESULT_TAG, "INSERT INTO retired_players(id, name, scores, playTime) VALUES($1, $2, $3, $4);"_zv);
+        conn.prepare(SELECT_LAST_RESULT_ID_TAG, "SELECT COALESCE(max(id), 0) FROM retired_players;"_zv);
+
+        if (config_.schema_mode == SchemaMode::partitioned) {
+            conn.prepare(SELECT_TOP_RESULTS_TAG, R"(SELECT id, name, scores, playTime FROM top_results ORDER BY scores DESC, playTime ASC, name COLLATE "C" ASC, id ASC LIMIT $1 OFFSET $2;)"_zv);
+            conn.prepare(SELECT_TOP_RESULTS_AFTER_TAG, R"(SELECT id, name, scores, playTime FROM top_results WHERE scores <= $1 AND (scores < $1 OR (playTime, name COLLATE "C", id) > ($2, $3, $4)) ORDER BY scores DESC, playTime ASC, name COLLATE "C" ASC, id ASC LIMIT $5;)"_zv);
+            conn.prepare(INSERT_TOP_RESULT_TAG, "INSERT INTO top_results(id, name, scores, playTime) VALUES($1, $2, $3, $4);"_zv);
+            conn.prepare(TRIM_TOP_RESULTS_TAG, R"(DELETE FROM top_results WHERE ctid IN (SELECT ctid FROM top_results ORDER BY scores DESC, playTime ASC, name COLLATE "C" ASC, id ASC OFFSET $1);)"_zv);
+        }
+    }
+
+    // Opens count connections with up to connect_threads of them in flight
+    void OpenConnections(unsigned int count) {
+        std::atomic<int> remaining = static_cast<int>(count);
+        std::exception_ptr error;
+        std::mutex error_m;
+
+        {
+            unsigned int threads_count = std::clamp(config_.connect_threads, 1u, std::max(count, 1u));
+
+            std::vector<std::jthread> threads;
+            threads.reserve(threads_count);
+
+            for (unsigned int i = 0; i < threads_count; ++i) {
+                threads.emplace_back([this, &remaining, &error, &error_m] {
+                    while (remaining.fetch_sub(1) > 0) {
+                        try {
+                            std::unique_ptr<pqxx::connection> conn = Connect();
+
+                            std::lock_guard lock{m_};
+                            idle_.emplace_back(std::move(conn));
+                            ++opened_;
+                            open_.Add();
+                        } catch (...) {
+                            std::lock_guard lock{error_m};
+                            if (!error) {
+                                error = std::current_exception();
+                            }
+                        }
+                    }
+                });
+            }
+        }
+
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void ReturnConnection(std::unique_ptr<pqxx::connection> && conn) {
+        in_use_.Sub();
+
+        std::unique_lock lock{m_};
+        idle_.emplace_back(std::move(conn));
+        lock.unlock();
+
+        cv_.notify_one();
+    }
+
+    Config config_;
+    std::string connection_string_;
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<pqxx::connection>> idle_;
+    unsigned int opened_ = 0;
+
+    metrics::Counter & checkouts_;
+    metrics::Counter & exhausted_;
+    metrics::Gauge & in_use_;
+    metrics::Gauge & open_;
+    metrics::Timing & wait_time_;
+
+    bool partitioned_ = false;
+//  *   Declared last: it is stopped before the rest of the pool is destroyed
+    std::jthread partitions_maintainer_;
+};
+
+class GameResultRepository : public app::IGameResultRepository {
+public:
+    // top_results_size is 0 when there is no top_results table
+    explicit GameResultRepository(pqxx::work & work, unsigned int top_results_size = 0) : work_{work}, top_results_size_{top_results_size} {}
+
+// *    Pages within the top-N are read from the small top_results table
+    std::vector<app::GameResult> GetResults(unsigned int results_count = max_results_count_, unsigned int offset = 0) override {
+        std::vector<app::GameResult> results;
+        results.reserve(results_count);
+
+        bool from_top = offset + results_count <= top_results_size_;
+
+        pqxx::result result = work_.exec_prepared(from_top ? SELECT_TOP_RESULTS_TAG : SELECT_RESULTS_TAG, results_count, offset);
+        ReadResults(result, results);
+
+        return results;
+    }
+    std::vector<app::GameResult> GetResultsAfter(const app::ResultsCursor & cursor, unsigned int results_count = max_results_count_) override {
+        std::vector<app::GameResult> results;
+        results.reserve(results_count);
+
+        if (top_results_size_ > 0) {
+            pqxx::result result = work_.exec_prepared(SELECT_TOP_RESULTS_AFTER_TAG, cursor.scores, cursor.session_duration, cursor.name, cursor.id, results_count);
+
+//  *   A short page may have hit the end of top_results rather than the end of the records
+            if (result.size() == results_count) {
+                ReadResults(result, results);
+                return results;
+            }
+        }
+
+        pqxx::result result = work_.exec_prepared(SELECT_RESULTS_AFTER_TAG, cursor.scores, cursor.session_duration, cursor.name, cursor.id, results_count);
+        ReadResults(result, results);
+
+        return results;
+    }
+    std::uint64_t GetLastResultId() override {
+        pqxx::result result = work_.exec_prepared(SELECT_LAST_RESULT_ID_TAG);
+        return result.at(0).at(0).as<std::uint64_t>();
+    }
+    void AddResult(const app::GameResult & game_result) override {
+        work_.exec_prepared(INSERT_RESULT_TAG, game_result.id_, game_result.name_, game_result.scores_, game_result.session_duration_);
+
+        if (top_results_size_ > 0) {
+            work_.exec_prepared(INSERT_TOP_RESULT_TAG, game_result.id_, game_result.name_, game_result.scores_, game_result.session_duration_);
+            work_.exec_prepared(TRIM_TOP_RESULTS_TAG, top_results_size_);
+        }
+    }
+
+// *    Batches go through COPY instead of a round trip per row
+    void AddResults(const std::vector<app::GameResult> & game_results) override {
+        if (game_results.empty()) {
+            return;
+        }
+
+        WriteResults("retired_players", game_results);
+
+//  *   top_results is maintained incrementally: the batch goes in, everything below the top-N goes out
+        if (top_results_size_ > 0) {
+            WriteResults("top_results", game_results);
+            work_.exec_prepared(TRIM_TOP_RESULTS_TAG, top_results_size_);
+        }
+    }
+private:
+    void WriteResults(std::string_view table, const std::vector<app::GameResult> & game_results) {
+        auto stream = pqxx::stream_to::table(work_, {table}, {"id", "name", "scores", "playtime"});
+
+        for (const app::GameResult & game_result : game_results) {
+            stream.write_values(game_result.id_, game_result.name_, game_result.scores_, game_result.session_duration_);
+        }
+
+        stream.complete();
+    }
+
+    static void ReadResults(const pqxx::result & result, std::vector<app::GameResult> & results) {
+        for (auto row = result.begin(); row != result.end(); ++row) {
+            std::uint64_t id = row->at(0).as<std::uint64_t>();
+            std::string name = row->at(1).as<std::string>();
+            unsigned int scores = row->at(2).as<unsigned int>();
+            unsigned int session_duration = row->at(3).as<unsigned int>();
+            results.emplace_back(name, scores, session_duration, id);
+        }
+    }
+
+    static const unsigned int max_results_count_ = 100;
+
+    pqxx::work & work_;
+    unsigned int top_results_size_;
+};
+
+class DbUnitOfWork : public app::IUnitOfWork {
+public:
+    using ConnectionHolder = ConnectionPool::ConnectionHolder;
+
+    explicit DbUnitOfWork(ConnectionHolder && conn, unsigned int top_results_size = 0) : conn_{std::move(conn)}, work_{*conn_}, game_result_repos_{work_, top_results_size} {}
+
+    ~DbUnitOfWork() {
+        try {
+            Commit();
+        } catch (...) {
+//  *   A failed transaction must not terminate the process from a destructor
+        }
+    }
+
+    app::IGameResultRepository * Results() override {
+        return &game_result_repos_;
+    }
+
+    void Commit() override {
+        work_.commit();
+    }
+private:
+    ConnectionHolder conn_;
+    pqxx::work work_;
+    GameResultRepository game_result_repos_;
+};
+
+class DbUnitOfWorkFactory : public app::IUnitOfWorkFactory {
+public:
+    explicit DbUnitOfWorkFactory(std::shared_ptr<ConnectionPool> pool) : pool_{pool} {}
+
+    std::shared_ptr<app::IUnitOfWork> NewUnitOfWork() override {
+        return std::make_shared<DbUnitOfWork>(std::move(pool_->GetConnection()), pool_->GetTopResultsSize());
+    }
+private:
+    std::shared_ptr<ConnectionPool> pool_;
+};
+
 } //namespace database
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#include "app.h"
+#include "metrics.h"
+
+namespace app {
+
+namespace net = boost::asio;
+
+// Runs repository calls on its own thread pool, so a slow query never occupies an IO thread
+// or the game strand. Completion is delivered through the executor of the caller's handler:
+// with net::use_awaitable the coroutine suspends on the call and resumes on its own executor.
+//
+// Waiting for a pooled connection happens on the executor threads only. Calls beyond MAX_QUEUED_PER_THREAD
+// per thread are not queued: they complete at once with StorageUnavailableError, and the caller answers 503.
+class DbExecutor {
+public:
+    static constexpr size_t MAX_QUEUED_PER_THREAD = 8;
+
+    DbExecutor(std::shared_ptr<IUnitOfWorkFactory> unit_of_work_factory, unsigned int threads_count)
+        : unit_of_work_factory_{std::move(unit_of_work_factory)}
+        , pool_{std::max(threads_count, 1u)}
+        , max_queued_{std::max(threads_count, 1u) * MAX_QUEUED_PER_THREAD}
+        , rejected_{metrics::Registry::Instance().GetCounter("db_executor_rejected_total")} {}
+
+    DbExecutor(const DbExecutor &) = delete;
+    DbExecutor & operator=(const DbExecutor &) = delete;
+
+    ~DbExecutor() {
+        pool_.join();
+    }
+
+    // Calls fn(IUnitOfWork &) in a new unit of work and commits it.
+    // Completes with (std::exception_ptr, result of fn); fn must return a non-void value.
+    template <typename Fn, typename CompletionToken>
+    auto Execute(Fn fn, CompletionToken && token) {
+        using Result = std::decay_t<std::invoke_result_t<Fn &, IUnitOfWork &>>;
+
+        return net::async_initiate<CompletionToken, void(std::exception_ptr, Result)>([this] (auto handler, Fn fn) {
+            auto work = net::make_work_guard(handler);
+
+            if (queued_.fetch_add(1, std::memory_order_relaxed) >= max_queued_) {
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                rejected_.Increment();
+
+                net::post(work.get_executor(), [handler = std::move(handler)] () mutable {
+                    std::move(handler)(std::make_exception_ptr(StorageUnavailableError("Database is busy")), Result{});
+                });
+                return;
+            }
+
+            net::post(pool_, [this, handler = std::move(handler), work = std::move(work), fn = std::move(fn)] () mutable {
+                std::exception_ptr error;
+                Result result{};
+
+                try {
+                    auto unit_of_work = unit_of_work_factory_->NewUnitOfWork();
+                    result = fn(*unit_of_work);
+                    unit_of_work->Commit();
+                } catch (...) {
+                    error = std::current_exception();
+                }
+
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+
+                auto executor = work.get_executor();
+                net::dispatch(executor, [handler = std::move(handler), error, result = std::move(result)] () mutable {
+                    std::move(handler)(error, std::move(result));
+                });
+                work.reset();
+            });
+        }, token, std::move(fn));
+    }
+
+private:
+    std::shared_ptr<IUnitOfWorkFactory> unit_of_work_factory_;
+    net::thread_pool pool_;
+
+    std::atomic<size_t> queued_ = 0;
+    size_t max_queued_;
+    metrics::Counter & rejected_;
+};
+
+} // namespace app
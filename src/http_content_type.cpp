@@ -1,53 +1,49 @@
-#include "http_content_type.h"
-
-namespace http_content_type {
-
-std::string_view GetContentTypeByExtension(std::string_view extension) {
-
-    if(extension == ".txt") {
-        return http_content_type::TEXT; 
-    }
-    else if (extension == ".htm" || extension == ".html") {
-        return http_content_type::HTML; 
-    }
-    else if (extension == ".css") {
-        return http_content_type::CSS; 
-    } 
-    else if (extension == ".js") {
-        return http_content_type::JS; 
-    } 
-    else if (extension == ".json") {
-        return http_content_type::JSON; 
-    } 
-    else if (extension == ".xml") {
-        return http_content_type::XML; 
-    } 
-    else if (extension == ".png") {
-        return http_content_type::PNG; 
-    } 
-    else if (extension == ".jpg" || extension == ".jpe" || extension == ".jpeg") {
-        return http_content_type::JPEG; 
-    }
-    else if (extension == ".gif") {
-        return http_content_type::GIF; 
-    }
-    else if (extension == ".bmp") {
-        return http_content_type::BMP; 
-    }
-    else if (extension == ".ico") {
-        return http_content_type::ICO;
-    }
-    else if (extension == ".tiff" || extension == ".tif") {
-        return http_content_type::TIFF; 
-    }
-    else if (extension == ".svg") {
-        return http_content_type::SVG; 
-    }
-    else if (extension == ".mp3") {
-        return http_content_type::MP3; 
-    }
-    else {
-        return http_content_type::EMPTY; 
-    }
-}
-} // namespace http_content_type
\ No newline at end of file
+#include "http_content_type.h"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace http_content_type {
+
+namespace {
+
+// Sorted by extension for the binary search
+constexpr std::array<std::pair<std::string_view, std::string_view>, 18> TYPES_BY_EXTENSION{{
+    {".bmp", BMP},
+    {".css", CSS},
+    {".gif", GIF},
+    {".htm", HTML},
+    {".html", HTML},
+    {".ico", ICO},
+    {".jpe", JPEG},
+    {".jpeg", JPEG},
+    {".jpg", JPEG},
+    {".js", JS},
+    {".json", JSON},
+    {".mp3", MP3},
+    {".png", PNG},
+    {".svg", SVG},
+    {".tif", TIFF},
+    {".tiff", TIFF},
+    {".txt", TEXT},
+    {".xml", XML}
+}};
+
+static_assert(std::is_sorted(TYPES_BY_EXTENSION.begin(), TYPES_BY_EXTENSION.end()));
+
+} // namespace
+
+std::string_view GetContentTypeByExtension(std::string_view extension) {
+    auto it = std::lower_bound(TYPES_BY_EXTENSION.begin(), TYPES_BY_EXTENSION.end(), extension, [] (const auto & type, std::string_view ext) {
+        return type.first < ext;
+    });
+
+    if (it == TYPES_BY_EXTENSION.end() || it->first != extension) {
+        return EMPTY;
+    }
+
+    return it->second;
+}
+
+} // namespace http_content_type
@@ -1,22 +1,305 @@
 #include "http_server.h"
 
+#include <algorithm>
+#include <cerrno>
+
+#include <boost/beast/websocket/rfc6455.hpp>
+
+#include <sys/sendfile.h>
+
+#include "metrics.h"
+
 namespace http_server {
 
+namespace {
+
+struct SessionMetrics {
+    static SessionMetrics & Instance() {
+        static SessionMetrics session_metrics;
+        return session_metrics;
+    }
+
+    metrics::Counter & connections = metrics::Registry::Instance().GetCounter("http_connections_total");
+    metrics::Gauge & active_connections = metrics::Registry::Instance().GetGauge("http_connections_active");
+    metrics::Counter & requests = metrics::Registry::Instance().GetCounter("http_requests_total");
+    // Requests after the first one of a connection
+    metrics::Counter & reused = metrics::Registry::Instance().GetCounter("http_keepalive_requests_total");
+    // Requests read while a previous one of the connection was in progress
+    metrics::Counter & pipelined = metrics::Registry::Instance().GetCounter("http_pipelined_requests_total");
+    metrics::Counter & idle_timeouts = metrics::Registry::Instance().GetCounter("http_idle_timeouts_total");
+    metrics::Counter & sendfile_bytes = metrics::Registry::Instance().GetCounter("http_sendfile_bytes_total");
+};
+
+constexpr unsigned MAX_PIPELINED = 64;
+
+} // namespace
+
+//  *   The peer address is taken once per connection instead of a syscall per logged request
+SessionBase::SessionBase(tcp::socket && socket, const Config & config)
+    : config_(config)
+    , stream_(std::move(socket))
+    , timer_(stream_.get_executor()) {
+    config_.max_pipelined = std::clamp(config_.max_pipelined, 1u, MAX_PIPELINED);
+
+    beast::error_code ec;
+    remote_address_ = stream_.socket().remote_endpoint(ec).address();
+
+    SessionMetrics::Instance().connections.Increment();
+    SessionMetrics::Instance().active_connections.Add();
+}
+
+SessionBase::~SessionBase() {
+    SessionMetrics::Instance().active_connections.Sub();
+}
+
 void SessionBase::Run() {
     net::dispatch(stream_.get_executor(), beast::bind_front_handler(&SessionBase::Read, GetSharedThis()));
 }
 
 void SessionBase::Read() {
-        using namespace std::literals;
+    request_ = {};
+    reading_ = true;
+
+    if (in_flight_ == 0) {
+        ArmTimer(config_.idle_timeout);
+    }
+
+    http::async_read(stream_, buf_, request_, beast::bind_front_handler(&SessionBase::OnRead, GetSharedThis()));
+}
+
+void SessionBase::OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read) {
+    reading_ = false;
+    access_log::Logger & log = access_log::Logger::Instance();
+
+    if (ec == http::error::end_of_stream) {
+//  *   Responses still in progress are written before the connection is closed
+        read_closed_ = true;
+        if (in_flight_ == 0 && !writing_) {
+            Close();
+        }
+    }
 
-        request_ = {};
-        stream_.expires_after(15s);
+    if (ec) {
+        log.LogError(ec, "read");
+        return;
+    }
 
-        http::async_read(stream_, buf_, request_, beast::bind_front_handler(&SessionBase::OnRead, GetSharedThis()));
+    SessionMetrics & session_metrics = SessionMetrics::Instance();
+    session_metrics.requests.Increment();
+    if (read_sequence_ > 0) {
+        session_metrics.reused.Increment();
+    }
+    if (in_flight_ > 0) {
+        session_metrics.pipelined.Increment();
     }
 
+    std::uint64_t sequence = read_sequence_++;
+    ++in_flight_;
+    if (!writing_) {
+        DisarmTimer();
+    }
+
+    std::uint64_t sampled_bit = std::uint64_t{1} << (sequence % MAX_PIPELINED);
+    if (log.SampleRequest()) {
+        sampled_ |= sampled_bit;
+        log.LogRequest(remote_address_, request_.target(), request_.method());
+    } else {
+        sampled_ &= ~sampled_bit;
+    }
+
+//  *   Nothing is read after a request that closes the connection or may take it over for a WebSocket
+    if (!request_.keep_alive() || (config_.max_requests > 0 && read_sequence_ >= config_.max_requests) || beast::websocket::is_upgrade(request_)) {
+        read_closed_ = true;
+    }
+
+    HandleRequest(std::move(request_), sequence);
+
+    ContinueReading();
+}
+
+void SessionBase::Enqueue(std::uint64_t sequence, WriteOperation operation) {
+    if (closed_) {
+        return;
+    }
+
+    ready_.emplace_back(sequence, std::move(operation));
+
+    WriteNext();
+}
+
+void SessionBase::WriteNext() {
+    if (writing_ || closed_) {
+        return;
+    }
+
+    auto it = std::find_if(ready_.begin(), ready_.end(), [this] (const auto & ready) {
+        return ready.first == write_sequence_;
+    });
+
+    if (it == ready_.end()) {
+        return;
+    }
+
+    WriteOperation operation = std::move(it->second);
+    ready_.erase(it);
+
+    writing_ = true;
+    ArmTimer(config_.write_timeout);
+
+    operation(config_.max_requests > 0 && write_sequence_ + 1 >= config_.max_requests);
+}
+
+void SessionBase::OnWrite(bool close, unsigned code, std::string_view content_type, TimePoint start_time_response, beast::error_code ec) {
+    writing_ = false;
+    DisarmTimer();
+
+    access_log::Logger & log = access_log::Logger::Instance();
+
+    if (ec) {
+        closed_ = true;
+        ready_.clear();
+        log.LogError(ec, "write");
+        return;
+    }
+
+    if (sampled_ & (std::uint64_t{1} << (write_sequence_ % MAX_PIPELINED))) {
+        std::chrono::time_point<std::chrono::system_clock> now = std::chrono::system_clock::now();
+        auto response_time = std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time_response);
+
+        log.LogResponse(code, response_time, content_type);
+    }
+
+    ++write_sequence_;
+    --in_flight_;
+
+    if (close || (read_closed_ && in_flight_ == 0)) {
+        return Close();
+    }
+
+    WriteNext();
+
+    if (!writing_ && in_flight_ == 0 && reading_) {
+        ArmTimer(config_.idle_timeout);
+    }
+
+    ContinueReading();
+}
+
+void SessionBase::Write(WebSocketUpgrade && upgrade, [[maybe_unused]] TimePoint start_time_response, std::uint64_t sequence) {
+    auto upgrade_ptr = std::make_shared<WebSocketUpgrade>(std::move(upgrade));
+    auto self = GetSharedThis();
+
+    net::dispatch(stream_.get_executor(), [self, upgrade_ptr, sequence] {
+        self->Enqueue(sequence, [self, upgrade_ptr] ([[maybe_unused]] bool close) {
+            self->HandOver(*upgrade_ptr);
+        });
+    });
+}
+
+//  *   The upgrade request is the last one read, the session has nothing left to write
+void SessionBase::HandOver(WebSocketUpgrade & upgrade) {
+    writing_ = false;
+    closed_ = true;
+    ready_.clear();
+    DisarmTimer();
+
+    ++write_sequence_;
+    --in_flight_;
+
+    upgrade.on_upgrade(std::move(stream_), std::move(upgrade.request));
+}
+
+void SessionBase::WriteFile(std::shared_ptr<FileResponse> response, TimePoint start_time_response) {
+    auto serializer = std::make_shared<http::response_serializer<SendfileBody>>(*response);
+
+    http::async_write_header(stream_, *serializer, [self = GetSharedThis(), response, serializer, start_time_response] (beast::error_code ec, [[maybe_unused]] std::size_t bytes) {
+        if (ec) {
+            return self->OnWrite(true, response->result_int(), (*response)[http::field::content_type], start_time_response, ec);
+        }
+
+        self->SendFileBody(response, start_time_response);
+    });
+}
+
+//  *   The socket is non-blocking: sendfile copies what fits into the socket buffer and the rest waits until it is writable
+void SessionBase::SendFileBody(std::shared_ptr<FileResponse> response, TimePoint start_time_response) {
+    SendfileBody::value_type & file = response->body();
+    tcp::socket & socket = stream_.socket();
+
+    beast::error_code ec;
+    socket.native_non_blocking(true, ec);
+
+    while (!ec && file.GetSize() > 0) {
+        off_t offset = static_cast<off_t>(file.GetOffset());
+        ssize_t sent = ::sendfile(socket.native_handle(), file.GetHandle(), &offset, file.GetSize());
+
+        if (sent > 0) {
+            file.Consume(static_cast<std::uint64_t>(sent));
+            SessionMetrics::Instance().sendfile_bytes.Increment(static_cast<std::uint64_t>(sent));
+        } else if (sent == 0) {
+//  *   *   The file has been cut after its size was sent in the header
+            ec = net::error::eof;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            socket.async_wait(tcp::socket::wait_write, [self = GetSharedThis(), response, start_time_response] (beast::error_code ec) {
+                if (ec) {
+                    return self->OnWrite(true, response->result_int(), (*response)[http::field::content_type], start_time_response, ec);
+                }
+
+                self->SendFileBody(response, start_time_response);
+            });
+            return;
+        } else if (errno != EINTR) {
+            ec = beast::error_code{errno, boost::system::system_category()};
+        }
+    }
+
+    OnWrite(response->need_eof(), response->result_int(), (*response)[http::field::content_type], start_time_response, ec);
+}
+
+// The next request is read while the previous ones are in progress, up to max_pipelined of them
+void SessionBase::ContinueReading() {
+    if (!reading_ && !read_closed_ && !closed_ && in_flight_ < config_.max_pipelined) {
+        Read();
+    }
+}
+
+void SessionBase::ArmTimer(std::chrono::milliseconds timeout) {
+    timer_.expires_after(timeout);
+    timer_.async_wait([self = GetSharedThis()] (beast::error_code ec) {
+        if (!ec) {
+            self->OnTimeout();
+        }
+    });
+}
+
+void SessionBase::DisarmTimer() {
+    timer_.expires_at(net::steady_timer::time_point::max());
+}
+
+void SessionBase::OnTimeout() {
+//  *   The timer has been moved after this wait completed
+    if (timer_.expiry() > net::steady_timer::clock_type::now()) {
+        return;
+    }
+
+    if (in_flight_ == 0 && !writing_) {
+        SessionMetrics::Instance().idle_timeouts.Increment();
+    }
+
+    closed_ = true;
+    ready_.clear();
+
+    beast::error_code ec;
+    stream_.socket().close(ec);
+}
+
 void SessionBase::Close() {
-    stream_.socket().shutdown(tcp::socket::shutdown_send);
+    closed_ = true;
+    ready_.clear();
+    DisarmTimer();
+
+    beast::error_code ec;
+    stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
 }
 
 }  // namespace http_server
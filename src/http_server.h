@@ -7,13 +7,20 @@
 #include <boost/asio/post.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/strand.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <memory>
 #include <iostream>
 #include <chrono>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
-#include "logger.h"
+#include "access_log.h"
+#include "sendfile_body.h"
 
 namespace http_server {
 
@@ -24,74 +31,122 @@ namespace http = beast::http;
 using tcp = net::ip::tcp;
 using namespace std::literals;
 
+// Lets several acceptors listen on one port, the kernel spreads new connections between them
+using reuse_port = net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+
+using HttpRequest = http::request<http::string_body>;
+
+// Sent instead of a response to a WebSocket upgrade request: once the responses to the previous requests
+// of the connection are written, the HTTP session ends and on_upgrade gets its stream and the request
+struct WebSocketUpgrade {
+    HttpRequest request;
+    std::function<void(beast::tcp_stream && stream, HttpRequest && request)> on_upgrade;
+};
+
 class SessionBase {
 public:
+    struct Config {
+        // A connection without requests in progress is closed after this time
+        std::chrono::milliseconds idle_timeout{15s};
+        // Time given to a response to be written
+        std::chrono::milliseconds write_timeout{15s};
+        // The response to this request closes the connection, 0 is unlimited
+        std::uint64_t max_requests = 0;
+        // Requests read ahead of their responses
+        unsigned max_pipelined = 16;
+    };
+
     SessionBase(const SessionBase &) = delete;
     SessionBase& operator=(const SessionBase &) = delete;
 
     void Run();
 
 protected:
-    using HttpRequest = http::request<http::string_body>;
+    using FileResponse = http::response<SendfileBody>;
+    using TimePoint = std::chrono::time_point<std::chrono::system_clock>;
 
-    explicit SessionBase(tcp::socket && socket) : stream_(std::move(socket)) {}
-    ~SessionBase() = default;
-    
-    virtual void HandleRequest (HttpRequest && request) = 0;
+    SessionBase(tcp::socket && socket, const Config & config);
+    ~SessionBase();
 
+    // Requests of a connection are numbered from 0, the response is written with the number of its request
+    virtual void HandleRequest (HttpRequest && request, std::uint64_t sequence) = 0;
+
+    // May be called from any thread, responses are written in the order of their requests
     template <typename Body, typename Fields>
-    void Write(http::response<Body, Fields> && response, std::chrono::time_point<std::chrono::system_clock> start_time_response) {
+    void Write(http::response<Body, Fields> && response, TimePoint start_time_response, std::uint64_t sequence) {
         auto response_ptr = std::make_shared<http::response<Body, Fields>>(std::move(response));
         auto self = GetSharedThis();
 
-        http::async_write(stream_, *response_ptr, [response_ptr, self, start_time_response] (beast::error_code ec, std::size_t bytes) {
-            self->OnWrite(response_ptr->need_eof(), response_ptr, start_time_response, ec, bytes);
+        net::dispatch(stream_.get_executor(), [self, response_ptr, start_time_response, sequence] {
+            self->Enqueue(sequence, [self, response_ptr, start_time_response] (bool close) {
+                if (close) {
+                    response_ptr->keep_alive(false);
+                }
+
+                if constexpr (std::is_same_v<http::response<Body, Fields>, FileResponse>) {
+                    self->WriteFile(response_ptr, start_time_response);
+                } else {
+                    http::async_write(self->stream_, *response_ptr, [self, response_ptr, start_time_response] (beast::error_code ec, [[maybe_unused]] std::size_t bytes) {
+                        self->OnWrite(response_ptr->need_eof(), response_ptr->result_int(), (*response_ptr)[http::field::content_type], start_time_response, ec);
+                    });
+                }
+            });
         });
     }
 
-private:
-    void Read();
+    void Write(WebSocketUpgrade && upgrade, TimePoint start_time_response, std::uint64_t sequence);
 
-    void OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read) {
-        if (ec == http::error::end_of_stream) {
-            Close();
-        }
-
-        if (ec) {
-            BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{ "code", ec.value() }, {"text", ec.message()}, {"where", "read"}}) << logging::add_value(message_, "error");
-            return;
-        }
-
-        BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{ "ip", stream_.socket().remote_endpoint().address().to_string() }, {"URI", request_.target()}, {"method", request_.method_string()}}) << logging::add_value(message_, "request received");
-
-        HandleRequest(std::move(request_));
+    // Executor of the connection strand
+    net::any_io_executor GetExecutor() {
+        return stream_.get_executor();
     }
 
-    void OnWrite(bool close, auto response_ptr, std::chrono::time_point<std::chrono::system_clock> start_time_response, beast::error_code ec, [[maybe_unused]] std::size_t bytes_written) {
-        if (ec) {
-            BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{ "code", ec.value() }, {"text", ec.message()}, {"where", "write"}}) << logging::add_value(message_, "error");
-            return;
-        }
+private:
+    // Starts the write of a ready response, close asks it to close the connection
+    using WriteOperation = std::function<void(bool close)>;
 
-        std::chrono::time_point<std::chrono::system_clock> now = std::chrono::system_clock::now();
-        auto response_time = std::chrono::duration_cast<std::chrono::milliseconds>(now - start_time_response);
+    void Read();
+    void OnRead(beast::error_code ec, std::size_t bytes_read);
 
-        BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{ "code", response_ptr->result_int() }, {"response_time", response_time.count()}, {"content_type", (*response_ptr)[http::field::content_type]}}) << logging::add_value(message_, "response sent");
+    void Enqueue(std::uint64_t sequence, WriteOperation operation);
+    void WriteNext();
+    void OnWrite(bool close, unsigned code, std::string_view content_type, TimePoint start_time_response, beast::error_code ec);
 
-        if (close) {
-            return Close();
-        }
+    // The header goes through Beast, the body is copied to the socket by the kernel
+    void WriteFile(std::shared_ptr<FileResponse> response, TimePoint start_time_response);
+    void SendFileBody(std::shared_ptr<FileResponse> response, TimePoint start_time_response);
 
-        Read();
-    }
+    void HandOver(WebSocketUpgrade & upgrade);
+
+    void ContinueReading();
+    void ArmTimer(std::chrono::milliseconds timeout);
+    void DisarmTimer();
+    void OnTimeout();
 
     virtual std::shared_ptr<SessionBase> GetSharedThis() = 0;
 
     void Close();
 
+    Config config_;
+
     beast::tcp_stream stream_;
     beast::flat_buffer buf_;
     HttpRequest request_;
+    net::steady_timer timer_;
+
+    net::ip::address remote_address_;
+
+//  *   Used on the stream strand only
+    std::uint64_t read_sequence_ = 0;
+    std::uint64_t write_sequence_ = 0;
+    unsigned in_flight_ = 0;
+    bool reading_ = false;
+    bool writing_ = false;
+    bool read_closed_ = false;
+    bool closed_ = false;
+    std::vector<std::pair<std::uint64_t, WriteOperation>> ready_;
+    // Bit (sequence % 64) tells whether the access log has sampled the request
+    std::uint64_t sampled_ = 0;
 
 };
 
@@ -99,13 +154,33 @@ template <typename RequestHandler>
 class Session : public SessionBase, public std::enable_shared_from_this<Session<RequestHandler>> {
 public:
     template <typename Handler>
-    Session (tcp::socket && socket, Handler && handler) : SessionBase(std::move(socket)), handler_(std::forward<Handler>(handler)) {}
+    Session (tcp::socket && socket, Handler && handler, const Config & config) : SessionBase(std::move(socket), config), handler_(std::forward<Handler>(handler)) {}
 
 protected:
-    void HandleRequest(HttpRequest && request) override {
-        handler_(std::move(request), [self=this->shared_from_this()] (auto && response, std::chrono::time_point<std::chrono::system_clock> start_time_response) {
-            self->Write(std::move(response), start_time_response);
-        });
+    // Writes the response of one request. Its executor is the connection strand, so work that a request
+    // starts elsewhere (a database query) resumes on the IO thread of its connection.
+    class ResponseSender {
+    public:
+        using executor_type = net::any_io_executor;
+
+        ResponseSender(std::shared_ptr<Session> session, std::uint64_t sequence) : session_{std::move(session)}, sequence_{sequence} {}
+
+        executor_type get_executor() const noexcept {
+            return session_->GetExecutor();
+        }
+
+        template <typename Response>
+        void operator()(Response && response, TimePoint start_time_response) const {
+            session_->Write(std::move(response), start_time_response, sequence_);
+        }
+
+    private:
+        std::shared_ptr<Session> session_;
+        std::uint64_t sequence_;
+    };
+
+    void HandleRequest(HttpRequest && request, std::uint64_t sequence) override {
+        handler_(std::move(request), ResponseSender{this->shared_from_this(), sequence});
     }
 private:
     std::shared_ptr<SessionBase> GetSharedThis() override {
@@ -120,13 +195,17 @@ template <typename RequestHandler>
 class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
 public:
     template <typename Handler>
-    Listener (net::io_context & io, const tcp::endpoint & endpoint, Handler && handler) : 
+    Listener (net::io_context & io, const tcp::endpoint & endpoint, Handler && handler, const SessionBase::Config & config, bool share_port) : 
     io_(io),
     endpoint_(endpoint),
     acceptor_(net::make_strand(io)),
-    handler_(std::forward<Handler>(handler)) {
+    handler_(std::forward<Handler>(handler)),
+    config_(config) {
         acceptor_.open(endpoint.protocol());
         acceptor_.set_option(tcp::acceptor::reuse_address(true));
+        if (share_port) {
+            acceptor_.set_option(reuse_port(true));
+        }
         acceptor_.bind(endpoint);
         acceptor_.listen();
     }
@@ -137,7 +216,7 @@ public:
 
     void OnAccept (beast::error_code ec, tcp::socket socket) {
         if (ec) {
-            BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{ "code", ec.value() }, {"text", ec.message()}, {"where", "accept"}}) << logging::add_value(message_, "error");
+            access_log::Logger::Instance().LogError(ec, "accept");
             return;
         }
 
@@ -147,7 +226,7 @@ public:
     }
 
     void AsyncRunSession(tcp::socket && socket) {
-        std::make_shared<Session<RequestHandler>>(std::move(socket), std::move(handler_))->Run();
+        std::make_shared<Session<RequestHandler>>(std::move(socket), handler_, config_)->Run();
     }
 
 private:
@@ -155,14 +234,17 @@ private:
     tcp::endpoint endpoint_;
     tcp::acceptor acceptor_;
     RequestHandler handler_;
+    SessionBase::Config config_;
 
 };
 
+// With share_port every io_context may have its own listener on the same endpoint,
+// a connection then stays on the thread of the context that accepted it
 template <typename RequestHandler>
-void ServeHttp(net::io_context & io, const tcp::endpoint & endpoint, RequestHandler && handler) {
+void ServeHttp(net::io_context & io, const tcp::endpoint & endpoint, RequestHandler && handler, const SessionBase::Config & config = {}, bool share_port = false) {
     using ThisListener = Listener<RequestHandler>;
 
-    std::make_shared<ThisListener>(io, endpoint, std::forward<RequestHandler>(handler))->DoAccept();
+    std::make_shared<ThisListener>(io, endpoint, std::forward<RequestHandler>(handler), config, share_port)->DoAccept();
 }
 
 }  // namespace http_server
@@ -1,128 +1,332 @@
-#include <string>
-
-#include <boost/algorithm/string.hpp>
-
-#include "http_utils.h"
-
-namespace http_utils {
-
-int PathBased(fs::path target_path, fs::path base) {
-    target_path = fs::weakly_canonical(target_path);
-    base = fs::weakly_canonical(base);
-
-    std::vector<std::string> target_path_end_slitted;
-
-    boost::split(target_path_end_slitted, target_path.string(), boost::is_any_of("?"));
-
-    target_path.replace_filename(target_path_end_slitted.at(0));
-
-    int after = -1;
-
-    auto tp = target_path.begin();
-    auto b = base.begin();
-
-    auto tp_end = target_path.end();
-    auto b_end = base.end();
-// *    FIX THIS: The last element of "api/v1/" ---> *tp = "" <---- BUT "api/v1" ----> *tp = target_path.end() <----- 
-    if (*(--tp_end) != "") ++tp_end;
-    if (*(--b_end) != "") ++b_end;
-// *    ========
-    for (; b != b_end; ++b, ++tp) {
-
-        if (tp == tp_end || *tp != *b) {
-
-            return after;
-        }
-    }
-
-    after = std::distance(tp, tp_end);
-
-    return after;
-}
-
-bool MatchPaths(fs::path target_path, fs::path path) {
-    target_path = fs::weakly_canonical(target_path);
-    path = fs::weakly_canonical(path);
-
-    if ( std::distance(target_path.end(), target_path.begin()) != std::distance(path.end(), path.begin()) ) {
-        return false;
-    }
-
-    for (auto tp = target_path.begin(), p = path.begin(); tp != target_path.end(); ++tp, ++p) {
-        if (*tp != *p) {
-
-            return false;
-        }
-    }
-
-    return true;
-}
-
-std::string UrlDecode(std::string_view encoded_str) {
-    std::string decoded_str{encoded_str.begin(), encoded_str.end()};
-
-    size_t pos = std::string::npos;
-
-    char symbol = '\0';
-
-    while ((pos = decoded_str.find('%')) != std::string::npos) {
-        if (pos >= decoded_str.size()-2) {
-            throw std::invalid_argument("Parse trouble: code is not full");
-        }
-
-        std::string code{decoded_str.substr(pos+1, 2).c_str()};
-
-        if (code[0] >= 'A' && code[0] <= 'F') {
-
-            symbol = (code[0]-'A'+10) * 16;
-        } else if (code[0] >= 'a' && code[0] <= 'f') {
-
-            symbol = (code[0]-'a'+10) * 16;
-        } else if (code[0] >= '0' && code[0] <= '9') {
-
-            symbol = (code[0]-'0') * 16;
-        } else {
-
-            throw std::invalid_argument("Parse trouble: invalid symbols");
-        }
-
-        if (code[1] >= 'A' && code[1] <= 'F') {
-
-            symbol += code[1]-'A'+10;
-        } else if (code[1] >= 'a' && code[1] <= 'f') {
-
-            symbol += (code[1]-'a'+10);
-        } else if (code[1] >= '0' && code[1] <= '9') {
-
-            symbol += code[1]-'0';
-        } else {
-
-            throw std::invalid_argument("Parse trouble: invalid symbols");
-        }
-
-        decoded_str.replace(pos, 3, 1, symbol);
-
-        symbol = '\0';
-    }
-
-    while ((pos = decoded_str.find('+')) != std::string::npos) {
-        decoded_str.replace(pos, 1, 1, ' ');
-    }
-
-    return decoded_str;
-}
-
-std::string FormatToken(std::string_view token) {
-    std::string::size_type pos = token.find(' ');
-
-    auto begin = token.begin()+pos+1;
-    auto end = token.begin()+pos+33;
-
-    if (token.end() - end < 0) {
-        throw std::invalid_argument("Parse error: invalid size");
-    }
-
-    return std::string{begin, end};
-}
-
+#include <algorithm>
+#include <charconv>
+#include <string>
+
+#include <boost/algorithm/string.hpp>
+
+#include "http_utils.h"
+
+namespace http_utils {
+
+namespace {
+
+std::string_view CutQuery(std::string_view path) {
+    return path.substr(0, path.find('?'));
+}
+
+// Cuts the next non-empty segment off rest
+bool NextSegment(std::string_view & rest, std::string_view & segment) {
+    while (!rest.empty() && rest.front() == '/') {
+        rest.remove_prefix(1);
+    }
+
+    if (rest.empty()) {
+        return false;
+    }
+
+    segment = rest.substr(0, rest.find('/'));
+    rest.remove_prefix(segment.size());
+
+    return true;
+}
+
+std::string_view Trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+        value.remove_suffix(1);
+    }
+
+    return value;
+}
+
+// Cuts the next comma separated item off rest
+std::string_view NextListItem(std::string_view & rest) {
+    size_t end = rest.find(',');
+    std::string_view item = Trim(rest.substr(0, end));
+    rest = end == std::string_view::npos ? std::string_view{} : rest.substr(end + 1);
+
+    return item;
+}
+
+bool ParseNumber(std::string_view text, std::uint64_t & value) {
+    if (text.empty()) {
+        return false;
+    }
+
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+
+    return ec == std::errc{} && end == text.data() + text.size();
+}
+
+} // namespace
+
+std::string_view NormalizePath(std::string & path) {
+    path.resize(CutQuery(path).size());
+
+    if (path.empty() || path.front() != '/') {
+        path.insert(path.begin(), '/');
+    }
+
+// *    Segments are written as "/segment" over the input, the output is never longer than the part already read
+    size_t written = 0;
+    bool trailing_slash = false;
+
+    std::string_view rest{path};
+    std::string_view segment;
+
+    while (!rest.empty()) {
+        rest.remove_prefix(1);
+
+        segment = rest.substr(0, rest.find('/'));
+        rest.remove_prefix(segment.size());
+
+        trailing_slash = true;
+
+        if (segment.empty() || segment == ".") {
+            continue;
+        }
+
+        if (segment == "..") {
+            while (written > 0 && path[written - 1] != '/') {
+                --written;
+            }
+            if (written > 0) {
+                --written;
+            }
+            continue;
+        }
+
+        path[written++] = '/';
+        std::copy(segment.begin(), segment.end(), path.begin() + written);
+        written += segment.size();
+
+        trailing_slash = false;
+    }
+
+    if (trailing_slash || written == 0) {
+        path[written++] = '/';
+    }
+
+    path.resize(written);
+
+    return path;
+}
+
+int PathBased(std::string_view target_path, std::string_view base) {
+    target_path = CutQuery(target_path);
+
+    std::string_view target_segment;
+    std::string_view base_segment;
+
+    while (NextSegment(base, base_segment)) {
+        if (!NextSegment(target_path, target_segment) || target_segment != base_segment) {
+            return -1;
+        }
+    }
+
+    int after = 0;
+
+    while (NextSegment(target_path, target_segment)) {
+        ++after;
+    }
+
+    return after;
+}
+
+bool MatchPaths(std::string_view target_path, std::string_view path) {
+    return PathBased(target_path, path) == 0;
+}
+
+std::string UrlDecode(std::string_view encoded_str) {
+    std::string decoded_str{encoded_str.begin(), encoded_str.end()};
+
+    size_t pos = std::string::npos;
+
+    char symbol = '\0';
+
+    while ((pos = decoded_str.find('%')) != std::string::npos) {
+        if (pos >= decoded_str.size()-2) {
+            throw std::invalid_argument("Parse trouble: code is not full");
+        }
+
+        std::string code{decoded_str.substr(pos+1, 2).c_str()};
+
+        if (code[0] >= 'A' && code[0] <= 'F') {
+
+            symbol = (code[0]-'A'+10) * 16;
+        } else if (code[0] >= 'a' && code[0] <= 'f') {
+
+            symbol = (code[0]-'a'+10) * 16;
+        } else if (code[0] >= '0' && code[0] <= '9') {
+
+            symbol = (code[0]-'0') * 16;
+        } else {
+
+            throw std::invalid_argument("Parse trouble: invalid symbols");
+        }
+
+        if (code[1] >= 'A' && code[1] <= 'F') {
+
+            symbol += code[1]-'A'+10;
+        } else if (code[1] >= 'a' && code[1] <= 'f') {
+
+            symbol += (code[1]-'a'+10);
+        } else if (code[1] >= '0' && code[1] <= '9') {
+
+            symbol += code[1]-'0';
+        } else {
+
+            throw std::invalid_argument("Parse trouble: invalid symbols");
+        }
+
+        decoded_str.replace(pos, 3, 1, symbol);
+
+        symbol = '\0';
+    }
+
+    while ((pos = decoded_str.find('+')) != std::string::npos) {
+        decoded_str.replace(pos, 1, 1, ' ');
+    }
+
+    return decoded_str;
+}
+
+std::optional<std::string_view> GetQueryParam(std::string_view target, std::string_view name) {
+    size_t query = target.find('?');
+    if (query == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    for (std::string_view rest = target.substr(query + 1); !rest.empty();) {
+        size_t end = rest.find('&');
+        std::string_view param = rest.substr(0, end);
+        rest = end == std::string_view::npos ? std::string_view{} : rest.substr(end + 1);
+
+        size_t eq = param.find('=');
+        if (param.substr(0, eq) == name) {
+            return eq == std::string_view::npos ? std::string_view{} : param.substr(eq + 1);
+        }
+    }
+
+    return std::nullopt;
+}
+
+std::string FormatToken(std::string_view token) {
+    std::string::size_type pos = token.find(' ');
+
+    auto begin = token.begin()+pos+1;
+    auto end = token.begin()+pos+33;
+
+    if (token.end() - end < 0) {
+        throw std::invalid_argument("Parse error: invalid size");
+    }
+
+    return std::string{begin, end};
+}
+
+bool AcceptsEncoding(std::string_view accept_encoding, std::string_view coding) {
+    bool accepted = false;
+
+    while (!accept_encoding.empty()) {
+        std::string_view item = NextListItem(accept_encoding);
+
+        size_t params = item.find(';');
+        std::string_view name = Trim(item.substr(0, params));
+
+        bool zero_quality = false;
+        if (params != std::string_view::npos) {
+            std::string_view quality = Trim(item.substr(params + 1));
+            if (quality.starts_with("q=") || quality.starts_with("Q=")) {
+                quality.remove_prefix(2);
+                zero_quality = quality.find_first_not_of("0.") == std::string_view::npos;
+            }
+        }
+
+// *    An explicit entry of the coding wins over "*"
+        if (boost::iequals(name, coding)) {
+            return !zero_quality;
+        }
+
+        if (name == "*") {
+            accepted = !zero_quality;
+        }
+    }
+
+    return accepted;
+}
+
+bool MatchesEtag(std::string_view if_none_match, std::string_view etag) {
+    if (Trim(if_none_match) == "*") {
+        return true;
+    }
+
+    if (etag.starts_with("W/")) {
+        etag.remove_prefix(2);
+    }
+
+    while (!if_none_match.empty()) {
+        std::string_view item = NextListItem(if_none_match);
+
+        if (item.starts_with("W/")) {
+            item.remove_prefix(2);
+        }
+
+        if (item == etag) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::optional<ByteRange> ParseRange(std::string_view range, std::uint64_t size) {
+    range = Trim(range);
+
+    if (!range.starts_with("bytes=") || range.find(',') != std::string_view::npos) {
+        return std::nullopt;
+    }
+    range.remove_prefix(6);
+
+    size_t dash = range.find('-');
+    if (dash == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    std::string_view first_text = Trim(range.substr(0, dash));
+    std::string_view last_text = Trim(range.substr(dash + 1));
+
+    std::uint64_t first = 0;
+    std::uint64_t last = 0;
+
+// *    "bytes=-N": the last N bytes
+    if (first_text.empty()) {
+        if (!ParseNumber(last_text, last)) {
+            return std::nullopt;
+        }
+        if (last == 0 || size == 0) {
+            return ByteRange{.satisfiable = false};
+        }
+
+        return ByteRange{size - std::min(last, size), size - 1};
+    }
+
+    if (!ParseNumber(first_text, first) || (!last_text.empty() && !ParseNumber(last_text, last))) {
+        return std::nullopt;
+    }
+
+    if (last_text.empty() || last >= size) {
+        last = size - 1;
+    } else if (last < first) {
+        return std::nullopt;
+    }
+
+    if (first >= size) {
+        return ByteRange{.satisfiable = false};
+    }
+
+    return ByteRange{first, last};
+}
+
 } // namespace http_utils
\ No newline at end of file
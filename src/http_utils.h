@@ -1,16 +1,44 @@
-#pragma once
-
-#include <filesystem>
-
-namespace http_utils {
-
-namespace fs = std::filesystem;
-
-int PathBased(fs::path target_path, fs::path base);
-bool MatchPaths(fs::path target_path, fs::path path);
-
-std::string UrlDecode(std::string_view encoded_str);
-
-std::string FormatToken(std::string_view token);
-
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace http_utils {
+
+// Cuts the query string off and lexically normalizes the absolute path in place:
+// empty and "." segments are dropped, ".." drops the previous segment but never goes above the root,
+// a trailing slash is kept. Returns path as a view, nothing is allocated and the filesystem is not touched.
+std::string_view NormalizePath(std::string & path);
+
+// Paths are compared by segments and are expected to be normalized, the query string of target_path is ignored.
+// Returns the number of segments of target_path after base, -1 if target_path is not based on base.
+int PathBased(std::string_view target_path, std::string_view base);
+bool MatchPaths(std::string_view target_path, std::string_view path);
+
+std::string UrlDecode(std::string_view encoded_str);
+
+// Value of the first name=value pair of the query string of target, nullopt if there is none
+std::optional<std::string_view> GetQueryParam(std::string_view target, std::string_view name);
+
+std::string FormatToken(std::string_view token);
+
+// Whether an Accept-Encoding value allows coding: it is listed, or "*" is, without "q=0"
+bool AcceptsEncoding(std::string_view accept_encoding, std::string_view coding);
+
+// Whether an If-None-Match value is "*" or lists etag, "W/" prefixes are ignored
+bool MatchesEtag(std::string_view if_none_match, std::string_view etag);
+
+// Inclusive byte positions, an unsatisfiable range is answered with 416
+struct ByteRange {
+    std::uint64_t first = 0;
+    std::uint64_t last = 0;
+    bool satisfiable = true;
+};
+
+// Parses a Range value of a resource of size bytes. A value that is not a single "bytes" range
+// gives nullopt, the whole resource is sent then.
+std::optional<ByteRange> ParseRange(std::string_view range, std::uint64_t size);
+
 } // namespace http_utils
\ No newline at end of file
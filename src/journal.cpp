@@ -0,0 +1,499 @@
+#include "journal.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "logger.h"
+#include "snapshot.h"
+
+namespace journal {
+
+namespace {
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+// Payload size and CRC-32 precede the checked part of a record
+constexpr size_t FRAME_SIZE = 2 * sizeof(std::uint32_t);
+
+template <typename T>
+void Put(std::string & out, T value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void PutString(std::string & out, std::string_view str) {
+    Put(out, static_cast<std::uint32_t>(str.size()));
+    out.append(str);
+}
+
+class Reader {
+public:
+    explicit Reader(std::string_view data) : data_{data} {}
+
+    template <typename T>
+    T Get() {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        T value;
+        std::memcpy(&value, GetBytes(sizeof(T)).data(), sizeof(T));
+
+        return value;
+    }
+
+    std::string_view GetString() {
+        return GetBytes(Get<std::uint32_t>());
+    }
+
+    std::string_view GetBytes(size_t size) {
+        if (data_.size() - pos_ < size) {
+            throw std::invalid_argument("Journal record is truncated"s);
+        }
+
+        std::string_view bytes = data_.substr(pos_, size);
+        pos_ += size;
+
+        return bytes;
+    }
+
+private:
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+void PutPayload(std::string & out, const JoinRecord & record) {
+    Put(out, record.player_id);
+    out.append(app::TokenView(record.token));
+    PutString(out, record.name);
+    PutString(out, record.map_id);
+    Put(out, record.x);
+    Put(out, record.y);
+    Put(out, record.join_time);
+}
+
+void PutPayload(std::string & out, const MoveRecord & record) {
+    Put(out, record.player_id);
+    Put(out, static_cast<std::uint8_t>(record.direction));
+}
+
+void PutPayload(std::string & out, const TickRecord & record) {
+    Put(out, record.delta);
+    Put(out, record.seed);
+}
+
+void PutPayload(std::string & out, const RetireRecord & record) {
+    Put(out, record.player_id);
+}
+
+RecordType GetType(const Record & record) {
+    static constexpr RecordType TYPES[] = {RecordType::JOIN, RecordType::MOVE, RecordType::TICK, RecordType::RETIRE};
+    return TYPES[record.index()];
+}
+
+void EncodeRecord(std::string & out, std::uint64_t sequence, const Record & record) {
+    size_t frame_pos = out.size();
+    Put(out, std::uint32_t{0});
+    Put(out, std::uint32_t{0});
+
+    Put(out, sequence);
+    Put(out, static_cast<std::uint8_t>(GetType(record)));
+    std::visit([&out] (const auto & value) { PutPayload(out, value); }, record);
+
+    std::string_view checked = std::string_view{out}.substr(frame_pos + FRAME_SIZE);
+    std::uint32_t size = static_cast<std::uint32_t>(checked.size());
+    std::uint32_t crc = snapshot::Crc32(checked);
+
+    std::memcpy(out.data() + frame_pos, &size, sizeof(size));
+    std::memcpy(out.data() + frame_pos + sizeof(size), &crc, sizeof(crc));
+}
+
+Record DecodeRecord(RecordType type, Reader & reader) {
+    switch (type) {
+        case RecordType::JOIN: {
+            JoinRecord record;
+            record.player_id = reader.Get<std::int32_t>();
+            record.token = app::ParseToken(reader.GetBytes(app::TOKEN_SIZE));
+            record.name = reader.GetString();
+            record.map_id = reader.GetString();
+            record.x = reader.Get<double>();
+            record.y = reader.Get<double>();
+            record.join_time = reader.Get<std::int64_t>();
+            return record;
+        }
+        case RecordType::MOVE: {
+            std::int32_t player_id = reader.Get<std::int32_t>();
+            return MoveRecord{player_id, static_cast<model::Direction>(reader.Get<std::uint8_t>())};
+        }
+        case RecordType::TICK: {
+            std::int64_t delta = reader.Get<std::int64_t>();
+            return TickRecord{delta, reader.Get<std::uint32_t>()};
+        }
+        case RecordType::RETIRE:
+            return RetireRecord{reader.Get<std::int32_t>()};
+    }
+
+    throw std::invalid_argument("Unknown journal record type"s);
+}
+
+// Calls fn(sequence, record) for the records of a segment up to the first damaged one
+template <typename Fn>
+void ReadSegment(const fs::path & path, Fn && fn) {
+    std::ifstream in{path, std::ios::binary};
+    std::string data{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+
+    std::string_view rest{data};
+
+    while (rest.size() >= FRAME_SIZE) {
+        std::uint32_t size;
+        std::uint32_t crc;
+        std::memcpy(&size, rest.data(), sizeof(size));
+        std::memcpy(&crc, rest.data() + sizeof(size), sizeof(crc));
+
+        if (rest.size() - FRAME_SIZE < size) {
+            return;
+        }
+
+        std::string_view checked = rest.substr(FRAME_SIZE, size);
+        if (snapshot::Crc32(checked) != crc) {
+            return;
+        }
+
+        std::uint64_t sequence;
+        Record record;
+        try {
+            Reader reader{checked};
+            sequence = reader.Get<std::uint64_t>();
+            record = DecodeRecord(static_cast<RecordType>(reader.Get<std::uint8_t>()), reader);
+        } catch (const std::invalid_argument &) {
+            return;
+        }
+
+        fn(sequence, record);
+
+        rest.remove_prefix(FRAME_SIZE + size);
+    }
+}
+
+struct Segment {
+    std::uint64_t first_sequence;
+    fs::path path;
+};
+
+fs::path SegmentPath(const std::string & path, std::uint64_t first_sequence) {
+    return fs::path{path + "." + std::to_string(first_sequence)};
+}
+
+// Segments of the journal ordered by the sequence of their first record
+std::vector<Segment> ListSegments(const std::string & path) {
+    fs::path base{path};
+    fs::path dir = base.has_parent_path() ? base.parent_path() : fs::path{"."};
+    std::string prefix = base.filename().string() + ".";
+
+    std::vector<Segment> segments;
+
+    if (!fs::is_directory(dir)) {
+        return segments;
+    }
+
+    for (const fs::directory_entry & entry : fs::directory_iterator{dir}) {
+        std::string name = entry.path().filename().string();
+
+        if (!entry.is_regular_file() || !name.starts_with(prefix)) {
+            continue;
+        }
+
+        std::string_view suffix = std::string_view{name}.substr(prefix.size());
+        std::uint64_t first_sequence = 0;
+        auto [end, ec] = std::from_chars(suffix.data(), suffix.data() + suffix.size(), first_sequence);
+
+        if (ec == std::errc{} && end == suffix.data() + suffix.size()) {
+            segments.push_back(Segment{first_sequence, entry.path()});
+        }
+    }
+
+    std::sort(segments.begin(), segments.end(), [] (const Segment & lhs, const Segment & rhs) {
+        return lhs.first_sequence < rhs.first_sequence;
+    });
+
+    return segments;
+}
+
+} // namespace
+
+Journal::Journal(Config config)
+    : config_{std::move(config)}
+    , failures_{metrics::Registry::Instance().GetCounter("journal_write_failures_total")} {}
+
+Journal::~Journal() {
+    Stop();
+}
+
+void Journal::Recover(std::uint64_t checkpoint_sequence, const ReplayHandler & handler) {
+    sequence_ = checkpoint_sequence;
+
+    if (!IsEnabled()) {
+        return;
+    }
+
+    for (const Segment & segment : ListSegments(config_.path)) {
+        ReadSegment(segment.path, [this, checkpoint_sequence, &handler] (std::uint64_t sequence, const Record & record) {
+//  *   *   The checkpoint already contains it
+            if (sequence <= checkpoint_sequence) {
+                return;
+            }
+
+            if (sequence > sequence_ + 1) {
+                throw std::runtime_error("Journal records "s + std::to_string(sequence_ + 1) + " to "s + std::to_string(sequence - 1) + " are missing, the save file is older than the journal kept"s);
+            }
+
+            if (sequence != sequence_ + 1) {
+                throw std::runtime_error("Journal record "s + std::to_string(sequence) + " does not follow record "s + std::to_string(sequence_));
+            }
+
+            handler(record);
+            sequence_ = sequence;
+        });
+    }
+
+    checkpoints_.push_back(checkpoint_sequence);
+    if (checkpoints_.size() >= config_.keep_checkpoints) {
+        retained_checkpoint_ = checkpoint_sequence;
+    }
+    pending_.push_back(Batch{sequence_ + 1, true, {}});
+
+    thread_ = std::jthread{[this] (std::stop_token stop_token) {
+        Run(stop_token);
+    }};
+}
+
+void Journal::Append(const Record & record) {
+    if (std::holds_alternative<JoinRecord>(record) || std::holds_alternative<MoveRecord>(record)) {
+        ++input_count_;
+    }
+
+    if (!IsEnabled()) {
+        return;
+    }
+
+    std::lock_guard lock{m_};
+
+    if (pending_.empty()) {
+        pending_.push_back(Batch{sequence_ + 1, false, {}});
+    }
+
+    std::string & data = pending_.back().data;
+    size_t size = data.size();
+    EncodeRecord(data, ++sequence_, record);
+
+    bool was_empty = pending_size_ == 0;
+    pending_size_ += data.size() - size;
+
+//  *   The writer waits for the batch to fill or for the commit interval to pass
+    if (was_empty || pending_size_ >= config_.commit_size) {
+        cv_.notify_one();
+    }
+}
+
+std::uint64_t Journal::BeginCheckpoint() {
+    std::lock_guard lock{m_};
+
+    if (IsEnabled()) {
+        pending_.push_back(Batch{sequence_ + 1, true, {}});
+    }
+
+    return sequence_;
+}
+
+void Journal::CompleteCheckpoint(std::uint64_t sequence) {
+    if (!IsEnabled()) {
+        return;
+    }
+
+    {
+        std::lock_guard lock{m_};
+        checkpoints_.push_back(sequence);
+
+        while (checkpoints_.size() > config_.keep_checkpoints) {
+            checkpoints_.pop_front();
+        }
+
+//  *   *   Until keep_checkpoints saves are written the older save files may still need every segment
+        if (checkpoints_.size() == config_.keep_checkpoints) {
+            retained_checkpoint_ = std::max(retained_checkpoint_, checkpoints_.front());
+        }
+    }
+
+    cv_.notify_one();
+}
+
+void Journal::Stop() {
+    if (thread_.joinable()) {
+        thread_.request_stop();
+        thread_.join();
+    }
+
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void Journal::Run(std::stop_token stop_token) {
+    std::unique_lock lock{m_};
+
+    while (true) {
+        cv_.wait(lock, stop_token, [this] {
+            return pending_size_ > 0 || retained_checkpoint_ > removed_checkpoint_;
+        });
+
+//  *   Group commit: records appended meanwhile share the write and the sync
+        if (pending_size_ > 0 && pending_size_ < config_.commit_size) {
+            cv_.wait_for(lock, stop_token, config_.commit_interval, [this] {
+                return pending_size_ >= config_.commit_size;
+            });
+        }
+
+        std::vector<Batch> batches = std::exchange(pending_, {});
+        pending_size_ = 0;
+        std::uint64_t checkpoint = retained_checkpoint_;
+
+        lock.unlock();
+
+        std::uint64_t round_segment = segment_first_sequence_;
+        std::uint64_t round_size = segment_size_;
+        bool failed = false;
+
+        try {
+            for (Batch & batch : batches) {
+                Write(batch);
+            }
+
+            if (fd_ >= 0 && ::fdatasync(fd_) != 0) {
+                throw std::system_error(errno, std::generic_category(), "fdatasync");
+            }
+
+            if (checkpoint > removed_checkpoint_) {
+                RemoveSegments(checkpoint);
+                removed_checkpoint_ = checkpoint;
+            }
+        } catch (const std::exception & ex) {
+            failed = true;
+            failures_.Increment();
+            BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{"exception", ex.what()}, {"where", "journal"}}) << logging::add_value(message_, "error");
+
+//  *   *   Nothing of this round is known to be on disk: the segment goes back to where the round started
+            if (fd_ >= 0) {
+                ::close(fd_);
+                fd_ = -1;
+            }
+            segment_first_sequence_ = round_segment;
+            segment_size_ = round_size;
+            torn_ = true;
+        }
+
+        lock.lock();
+
+        if (failed) {
+            size_t size = 0;
+            for (const Batch & batch : batches) {
+                size += batch.data.size();
+            }
+
+            pending_.insert(pending_.begin(), std::make_move_iterator(batches.begin()), std::make_move_iterator(batches.end()));
+            pending_size_ += size;
+
+//  *   *   Records that can't be written by the stop are lost, the next start replays the journal up to them
+            if (stop_token.stop_requested()) {
+                return;
+            }
+
+            cv_.wait_for(lock, stop_token, config_.retry_interval, [] {
+                return false;
+            });
+            continue;
+        }
+
+        if (stop_token.stop_requested() && pending_.empty()) {
+            return;
+        }
+    }
+}
+
+void Journal::Write(Batch & batch) {
+    if (batch.new_segment) {
+        if (fd_ >= 0) {
+            if (::fdatasync(fd_) != 0) {
+                throw std::system_error(errno, std::generic_category(), "fdatasync");
+            }
+            ::close(fd_);
+            fd_ = -1;
+        }
+
+        segment_first_sequence_ = batch.first_sequence;
+        segment_size_ = 0;
+        torn_ = false;
+    }
+
+    if (batch.data.empty()) {
+        return;
+    }
+
+//  *   A segment is opened once; a file left with this name has nothing after a damaged record.
+//  *   After a failure the segment is reopened and cut back to its last whole record.
+    if (fd_ < 0) {
+        fs::path path = SegmentPath(config_.path, segment_first_sequence_);
+
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (torn_ ? 0 : O_TRUNC), 0644);
+        if (fd_ < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + path.string());
+        }
+
+        if (torn_ && ::ftruncate(fd_, static_cast<off_t>(segment_size_)) != 0) {
+            throw std::system_error(errno, std::generic_category(), "ftruncate " + path.string());
+        }
+        torn_ = false;
+    }
+
+    std::string_view data{batch.data};
+
+    while (!data.empty()) {
+        ssize_t written = ::write(fd_, data.data(), data.size());
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "write");
+        }
+
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+
+    segment_size_ += batch.data.size();
+}
+
+void Journal::RemoveSegments(std::uint64_t sequence) {
+    std::vector<Segment> segments = ListSegments(config_.path);
+
+//  *   A segment is covered when the next one starts right after the checkpoint or earlier
+    for (size_t i = 0; i + 1 < segments.size(); ++i) {
+        if (segments[i + 1].first_sequence <= sequence + 1) {
+            std::error_code ec;
+            fs::remove(segments[i].path, ec);
+        }
+    }
+}
+
+} // namespace journal
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "model.h"
+#include "app.h"
+#include "metrics.h"
+
+// Write-ahead journal of the inputs that change the game state.
+//
+// Autosave writes a full checkpoint (a snapshot) from time to time; between checkpoints only the inputs
+// are appended here, so the steady cost of persistence follows the input rate instead of the world size.
+// Recovery loads the last checkpoint and replays the records that follow it.
+//
+// The journal is a set of segment files "<path>.<sequence of the first record>". Every checkpoint starts
+// a new segment. Once a checkpoint is on disk, the segments covered by the oldest of the last keep_checkpoints
+// checkpoints are removed, so that an older save generation can still be replayed up to the last input.
+// A failed write or sync is counted in journal_write_failures_total, its batches are kept and written again
+// from the last whole record, so that a transient error leaves no gap in the sequence.
+// Record: payload size (u32), CRC-32 of the rest of the record (u32), sequence (u64), type (u8), payload.
+namespace journal {
+
+enum class RecordType : std::uint8_t {
+    JOIN = 1,
+    MOVE = 2,
+    TICK = 3,
+    RETIRE = 4
+};
+
+// The token and the spawn point are random, so they are kept instead of being generated again
+struct JoinRecord {
+    std::int32_t player_id;
+    app::Token token;
+    std::string name;
+    std::string map_id;
+    double x;
+    double y;
+    std::int64_t join_time;
+};
+
+struct MoveRecord {
+    std::int32_t player_id;
+    model::Direction direction;
+};
+
+// Lost items are generated from RandomGenerator reseeded with seed before the tick
+struct TickRecord {
+    std::int64_t delta;
+    std::uint32_t seed;
+};
+
+struct RetireRecord {
+    std::int32_t player_id;
+};
+
+using Record = std::variant<JoinRecord, MoveRecord, TickRecord, RetireRecord>;
+
+class Journal {
+public:
+    using ReplayHandler = std::function<void(const Record &)>;
+
+    struct Config {
+        // An empty path disables the journal
+        std::string path;
+        // Appended records are written and synced together at most this long after the first of them
+        std::chrono::milliseconds commit_interval{20};
+        // A batch this large is written without waiting for the interval
+        size_t commit_size = 64 * 1024;
+        // Segments are kept for this many of the last checkpoints, one per save generation
+        unsigned keep_checkpoints = 1;
+        // Batches that failed to be written or synced are written again after this long
+        std::chrono::milliseconds retry_interval{1000};
+    };
+
+    explicit Journal(Config config);
+
+    Journal(const Journal &) = delete;
+    Journal & operator=(const Journal &) = delete;
+
+    ~Journal();
+
+    bool IsEnabled() const noexcept {
+        return !config_.path.empty();
+    }
+
+    // Replays the records after checkpoint_sequence and starts a new segment for the following ones.
+    // A segment is read up to its first damaged record, which is where a crash tore the last write.
+    // Throws std::runtime_error if records between the checkpoint and the journal are missing.
+    void Recover(std::uint64_t checkpoint_sequence, const ReplayHandler & handler);
+
+    // Must be called on the game strand after Recover, in the order the inputs are applied
+    void Append(const Record & record);
+
+    // Sequence of the last appended record
+    std::uint64_t GetSequence() const noexcept {
+        return sequence_;
+    }
+
+    // Number of appended player inputs (joins and moves), counted even when the journal is disabled.
+    // Ticks and retirements follow from the inputs, so the autosave scheduler counts changes by this.
+    std::uint64_t GetInputCount() const noexcept {
+        return input_count_;
+    }
+
+    // Called on the game strand when a checkpoint is captured.
+    // Returns the sequence of the last record the checkpoint covers, the next record starts a new segment.
+    std::uint64_t BeginCheckpoint();
+
+    // Called once the checkpoint has been written. Removes the segments no kept checkpoint needs.
+    void CompleteCheckpoint(std::uint64_t sequence);
+
+    // Writes the pending records and stops the thread
+    void Stop();
+
+private:
+    struct Batch {
+        std::uint64_t first_sequence;
+        bool new_segment;
+        std::string data;
+    };
+
+    void Run(std::stop_token stop_token);
+    void Write(Batch & batch);
+    void RemoveSegments(std::uint64_t sequence);
+
+    Config config_;
+
+    std::mutex m_;
+    std::condition_variable_any cv_;
+    std::uint64_t sequence_ = 0;
+    std::uint64_t input_count_ = 0;
+    std::vector<Batch> pending_;
+    size_t pending_size_ = 0;
+//  *   Last written checkpoints, the segments before the first of them are removed once there are keep_checkpoints
+    std::deque<std::uint64_t> checkpoints_;
+    std::uint64_t retained_checkpoint_ = 0;
+
+//  *   Used by the writer thread only
+    int fd_ = -1;
+    std::uint64_t segment_first_sequence_ = 0;
+//  *   Bytes of the segment that hold whole records, a failed write is cut back to it before the retry
+    std::uint64_t segment_size_ = 0;
+    bool torn_ = false;
+    std::uint64_t removed_checkpoint_ = 0;
+
+    metrics::Counter & failures_;
+
+    std::jthread thread_;
+};
+
+} // namespace journal
@@ -1,72 +1,76 @@
-#pragma once
-
-#include <boost/json.hpp>
-
-#include "model.h"
-#include "app.h"
-#include "extra_data.h"
-#include "json_fields.h"
-
-namespace json_builder {
-
-namespace json = boost::json;
-
-// * Get Page not found
-json::value GetPageNotFound ();
-std::string GetPageNotFound_s ();
-
-// * Get JSON of error: Bad request
-json::value GetBadRequest ();
-std::string GetBadRequest_s ();
-
-// * Get JSON that inform about json parse error
-json::value GetParseJsonError(std::string_view message = "");
-std::string GetParseJsonError_s(std::string_view message = ""); 
-
-// * Get JSON with method not allowed
-json::value GetMethodNotAllowed(std::string_view methods); 
-std::string GetMethodNotAllowed_s(std::string_view methods);
-
-// * Get JSON Invalid argument
-json::value GetInvalidArgument(std::string_view msg);
-std::string GetInvalidArgument_s(std::string_view msg);
-
-// * Get JSON of error: Map Not Found
-json::value GetMapNotFound ();
-std::string GetMapNotFound_s ();
-
-// * Get JSON of maps
-json::value GetMaps (const std::vector<model::Map> & maps);
-std::string GetMaps_s (const std::vector<model::Map> & maps);
-
-// * Get JSON of this map
-json::value GetMap(const model::Map & map);
-std::string GetMap_s(const model::Map & map);
-json::value GetMapWithExtraData(const model::Map & map, const extra_data::MapExtraData & extra_data);
-std::string GetMapWithExtraData_s(const model::Map & map, const extra_data::MapExtraData & extra_data);
-
-// * Get JSON that keep token and player id
-json::value GetTokenAndPlayerId(std::string_view token, int player_id);
-std::string GetTokenAndPlayerId_s(std::string_view token, int player_id);
-
-// * Get JSON unknown token
-json::value GetUnknownToken();
-std::string GetUnknownToken_s();
-
-// * Get JSON invalid token
-json::value GetInvalidToken();
-std::string GetInvalidToken_s();
-
-// * Get players list
-json::value GetPlayers(model::GameSession * session);
-std::string GetPlayers_s(model::GameSession * session);
-
-// * Get players info
-json::value GetPlayersInfo(model::GameSession * session);
-std::string GetPlayersInfo_s(model::GameSession * session);
-
-// * Get top game results
-json::array GetTopGameResults(std::vector<app::GameResult> results);
-std::string GetTopGameResults_s(std::vector<app::GameResult> results);
-
+#pragma once
+
+#include <boost/json.hpp>
+
+#include "model.h"
+#include "app.h"
+#include "extra_data.h"
+#include "json_fields.h"
+
+namespace json_builder {
+
+namespace json = boost::json;
+
+// * Get Page not found
+json::value GetPageNotFound ();
+std::string GetPageNotFound_s ();
+
+// * Get JSON of error: Bad request
+json::value GetBadRequest ();
+std::string GetBadRequest_s ();
+
+// * Get JSON that inform about json parse error
+json::value GetParseJsonError(std::string_view message = "");
+std::string GetParseJsonError_s(std::string_view message = ""); 
+
+// * Get JSON with method not allowed
+json::value GetMethodNotAllowed(std::string_view methods); 
+std::string GetMethodNotAllowed_s(std::string_view methods);
+
+// * Get JSON Invalid argument
+json::value GetInvalidArgument(std::string_view msg);
+std::string GetInvalidArgument_s(std::string_view msg);
+
+// * Get JSON of error: Service unavailable
+json::value GetServiceUnavailable(std::string_view msg);
+std::string GetServiceUnavailable_s(std::string_view msg);
+
+// * Get JSON of error: Map Not Found
+json::value GetMapNotFound ();
+std::string GetMapNotFound_s ();
+
+// * Get JSON of maps
+json::value GetMaps (const std::vector<model::Map> & maps);
+std::string GetMaps_s (const std::vector<model::Map> & maps);
+
+// * Get JSON of this map
+json::value GetMap(const model::Map & map);
+std::string GetMap_s(const model::Map & map);
+json::value GetMapWithExtraData(const model::Map & map, const extra_data::MapExtraData & extra_data);
+std::string GetMapWithExtraData_s(const model::Map & map, const extra_data::MapExtraData & extra_data);
+
+// * Get JSON that keep token and player id
+json::value GetTokenAndPlayerId(std::string_view token, int player_id);
+std::string GetTokenAndPlayerId_s(std::string_view token, int player_id);
+
+// * Get JSON unknown token
+json::value GetUnknownToken();
+std::string GetUnknownToken_s();
+
+// * Get JSON invalid token
+json::value GetInvalidToken();
+std::string GetInvalidToken_s();
+
+// * Get players list
+json::value GetPlayers(model::GameSession * session);
+std::string GetPlayers_s(model::GameSession * session);
+
+// * Get players info
+json::value GetPlayersInfo(model::GameSession * session);
+std::string GetPlayersInfo_s(model::GameSession * session);
+
+// * Get top game results
+json::array GetTopGameResults(std::vector<app::GameResult> results);
+std::string GetTopGameResults_s(std::vector<app::GameResult> results);
+
 } //namespace json_build
\ No newline at end of file
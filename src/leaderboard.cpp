@@ -0,0 +1,122 @@
+#include "leaderboard.h"
+
+#include <algorithm>
+
+#include "json_builder.h"
+
+namespace app {
+
+void Leaderboard::Seed(std::vector<GameResult> results) {
+    std::sort(results.begin(), results.end(), GameResultOrder{});
+
+    std::unique_lock lock{m_};
+
+    complete_ = results.size() < capacity_;
+
+    if (results.size() > capacity_) {
+        results.erase(results.begin() + capacity_, results.end());
+    }
+
+    results_ = std::move(results);
+    ++version_;
+}
+
+void Leaderboard::Add(const GameResult & result) {
+    std::unique_lock lock{m_};
+
+    auto it = std::upper_bound(results_.begin(), results_.end(), result, GameResultOrder{});
+
+//  *   Below the last held row of a truncated table: the database keeps it
+    if (it == results_.end() && !complete_ && results_.size() >= capacity_) {
+        return;
+    }
+
+    results_.insert(it, result);
+
+    if (results_.size() > capacity_) {
+        results_.pop_back();
+        complete_ = false;
+    }
+
+    ++version_;
+}
+
+std::optional<std::vector<GameResult>> Leaderboard::GetPage(size_t start, size_t max_items) const {
+    std::shared_lock lock{m_};
+
+    if (!Covers(start, max_items)) {
+        return std::nullopt;
+    }
+
+    size_t begin = std::min(start, results_.size());
+    size_t end = std::min(start + max_items, results_.size());
+
+    return std::vector<GameResult>(results_.begin() + begin, results_.begin() + end);
+}
+
+std::optional<std::vector<GameResult>> Leaderboard::GetPageAfter(const ResultsCursor & cursor, size_t max_items) const {
+    std::shared_lock lock{m_};
+
+    GameResult last{cursor.name, cursor.scores, cursor.session_duration, cursor.id};
+    size_t start = std::upper_bound(results_.begin(), results_.end(), last, GameResultOrder{}) - results_.begin();
+
+    if (!Covers(start, max_items)) {
+        return std::nullopt;
+    }
+
+    size_t end = std::min(start + max_items, results_.size());
+
+    return std::vector<GameResult>(results_.begin() + start, results_.begin() + end);
+}
+
+std::optional<std::string> Leaderboard::GetPageJson(size_t start, size_t max_items) const {
+    std::shared_lock lock{m_};
+
+    if (!Covers(start, max_items)) {
+        return std::nullopt;
+    }
+
+    PageKey key{start, max_items};
+
+    {
+        std::lock_guard cache_lock{cache_m_};
+
+        if (auto it = cache_.find(key); it != cache_.end() && it->second.version == version_) {
+            return it->second.json;
+        }
+    }
+
+    size_t begin = std::min(start, results_.size());
+    size_t end = std::min(start + max_items, results_.size());
+
+    std::string json = json_builder::GetTopGameResults_s({results_.begin() + begin, results_.begin() + end});
+
+    std::lock_guard cache_lock{cache_m_};
+
+//  *   Pages of an older version are useless, dropping them keeps the cache bounded
+    if (cache_.size() >= MAX_CACHED_PAGES) {
+        std::erase_if(cache_, [this] (const auto & page) {
+            return page.second.version != version_;
+        });
+
+        if (cache_.size() >= MAX_CACHED_PAGES) {
+            cache_.clear();
+        }
+    }
+
+    cache_.insert_or_assign(key, CachedPage{version_, json});
+
+    return json;
+}
+
+size_t Leaderboard::Size() const {
+    std::shared_lock lock{m_};
+    return results_.size();
+}
+
+std::uint64_t Leaderboard::GetVersion() const {
+    std::shared_lock lock{m_};
+    return version_;
+}
+
+} // namespace app
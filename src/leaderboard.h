@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "app.h"
+
+namespace app {
+
+// In-memory copy of the top of retired_players, kept in the same order as the records query
+// (scores DESC, playTime ASC, name ASC, id ASC). Pages that fit into it are served without the database,
+// and their serialized JSON is cached until the leaderboard changes.
+class Leaderboard {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1000;
+    static constexpr size_t MAX_CACHED_PAGES = 64;
+
+    explicit Leaderboard(size_t capacity = DEFAULT_CAPACITY) : capacity_{capacity} {}
+
+    Leaderboard(const Leaderboard &) = delete;
+    Leaderboard & operator=(const Leaderboard &) = delete;
+
+    // Replaces the content with the first rows of the table.
+    // Fewer rows than capacity means the table is held entirely.
+    void Seed(std::vector<GameResult> results);
+
+    void Add(const GameResult & result);
+
+    // Returns nullopt when the page reaches past the rows held in memory
+    std::optional<std::vector<GameResult>> GetPage(size_t start, size_t max_items) const;
+    std::optional<std::string> GetPageJson(size_t start, size_t max_items) const;
+
+    // Page following the cursor position
+    std::optional<std::vector<GameResult>> GetPageAfter(const ResultsCursor & cursor, size_t max_items) const;
+
+    size_t GetCapacity() const noexcept {
+        return capacity_;
+    }
+
+    size_t Size() const;
+
+    std::uint64_t GetVersion() const;
+
+private:
+    using PageKey = std::pair<size_t, size_t>;
+
+    struct CachedPage {
+        std::uint64_t version;
+        std::string json;
+    };
+
+    bool Covers(size_t start, size_t max_items) const {
+        return complete_ || start + max_items <= results_.size();
+    }
+
+    size_t capacity_;
+
+    mutable std::shared_mutex m_;
+    std::vector<GameResult> results_;
+    bool complete_ = false;
+    std::uint64_t version_ = 0;
+
+    mutable std::mutex cache_m_;
+    mutable std::map<PageKey, CachedPage> cache_;
+};
+
+} // namespace app
@@ -35,6 +35,18 @@ public:
      */
     unsigned Generate(TimeInterval time_delta, unsigned loot_count, unsigned looter_count);
 
+    /*
+     * Время, прошедшее без появления трофеев. Сохраняется вместе с состоянием игры,
+     * чтобы после восстановления трофеи появлялись так же, как до остановки сервера.
+     */
+    TimeInterval GetTimeWithoutLoot() const noexcept {
+        return time_without_loot_;
+    }
+
+    void SetTimeWithoutLoot(TimeInterval time_without_loot) noexcept {
+        time_without_loot_ = time_without_loot;
+    }
+
 private:
     static double DefaultGenerator() noexcept {
         return 1.0;
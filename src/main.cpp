@@ -11,6 +11,8 @@
 #include <thread>
 #include <memory>
 #include <signal.h>
+#include <pthread.h>
+#include <sched.h>
 #include <optional>
 #include <filesystem>
 
@@ -23,6 +25,10 @@
 
 #include "app.h"
 #include "database.h"
+#include "results_writer.h"
+#include "leaderboard.h"
+#include "db_executor.h"
+#include "results_store.h"
 #include "collision_detector.h"
 #include "command_line_args.h"
 #include "model.h"
@@ -31,10 +37,16 @@
 #include "json_loader.h"
 #include "request_handler.h"
 #include "logger.h"
+#include "access_log.h"
 #include "ticker.h"
 #include "extra_data.h"
 #include "serializer.h"
+#include "snapshot.h"
 #include "save_manager.h"
+#include "journal.h"
+#include "static_cache.h"
+#include "state_publisher.h"
+#include "random_generator.h"
 
 using namespace std::literals;
 namespace net = boost::asio;
@@ -65,6 +77,32 @@ void RunWorkers(unsigned threads_count, const Fn& fn) {
     fn();
 }
 
+// Pins the current thread to core index % number of cores
+void PinThread(unsigned index) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(index % std::max(1u, std::thread::hardware_concurrency()), &cpu_set);
+
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+}
+
+// Runs every IO context on its own thread and the game context on the current one
+void RunPerCore(net::io_context & game_ioc, std::vector<std::unique_ptr<net::io_context>> & io_contexts, bool pin_threads) {
+    std::vector<std::jthread> workers;
+    workers.reserve(io_contexts.size());
+
+    for (unsigned i = 0; i < io_contexts.size(); ++i) {
+        workers.emplace_back([&io = *io_contexts[i], i, pin_threads] {
+            if (pin_threads) {
+                PinThread(i);
+            }
+            io.run();
+        });
+    }
+
+    game_ioc.run();
+}
+
 [[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
     namespace po = boost::program_options;
 
@@ -79,7 +117,27 @@ void RunWorkers(unsigned threads_count, const Fn& fn) {
     add("config-file,c", po::value(&args.config_file)->value_name("file"), "set config file path");   
     add("www-root,w", po::value(&args.wwwroot_dir)->value_name("dir"), "set static files root");
     add("state-file", po::value(&args.save_file_path)->value_name("file"), "autosave file path");
+    add("save-compress", "compress save files with zlib");
+    add("save-fsync", po::value(&args.save_fsync)->value_name("none|file|full"), "set how save files are synced to disk: full also syncs the directory after the rename (by default)");
+    add("save-dirty-threshold", po::value(&args.save_dirty_threshold)->value_name("inputs"), "save the state once players have joined or moved this many times since the last save (off by default)");
+    add("save-generations", po::value(&args.save_generations)->value_name("count"), "set how many save files are kept, older ones are used if the newest can't be read (1 by default)");
     add("randomize-spawn-points", "spawn dogs at random positions");
+    add("db-pool-size", po::value(&args.db_pool_size)->value_name("connections"), "set database connection pool size (4 by default)");
+    add("db-connect-threads", po::value(&args.db_connect_threads)->value_name("threads"), "set number of database connections opened in parallel at startup");
+    add("db-acquire-timeout", po::value(&args.db_acquire_timeout)->value_name("milliseconds"), "set how long a request waits for a free database connection (200 by default)");
+    add("db-lazy-connect", "open database connections on demand");
+    add("db-schema", po::value(&args.db_schema)->value_name("plain|partitioned"), "set database schema mode: partitioned keeps retired players in monthly partitions and the best ones in top_results");
+    add("db-top-results", po::value(&args.db_top_results)->value_name("rows"), "set top_results size for the partitioned schema (1000 by default)");
+    add("results-store", po::value(&args.results_store_path)->value_name("file"), "keep game results in a local file instead of the database");
+    add("journal-file", po::value(&args.journal_path)->value_name("file"), "journal game inputs between autosaves and replay them on start");
+    add("journal-commit-interval", po::value(&args.journal_commit_interval)->value_name("milliseconds"), "set how long journal records wait to be written together (20 by default)");
+    add("log-sample-rate", po::value(&args.log_sample_rate)->value_name("N"), "log one of N requests with its response, errors are always logged (1 by default)");
+    add("io-per-core", "run an io_context and a SO_REUSEPORT acceptor per IO thread, connections stay on the thread that accepted them");
+    add("pin-threads", "pin IO threads to cores (with --io-per-core)");
+    add("keep-alive-timeout", po::value(&args.keep_alive_timeout)->value_name("milliseconds"), "close connections without requests in progress after this time (15000 by default)");
+    add("keep-alive-max-requests", po::value(&args.keep_alive_max_requests)->value_name("requests"), "close a connection after this many requests (unlimited by default)");
+    add("log-buffer-size", po::value(&args.log_buffer_size)->value_name("records"), "set the access log buffer of an IO thread, records that don't fit are dropped (4096 by default)");
+    add("static-cache-size", po::value(&args.static_cache_size)->value_name("megabytes"), "set the memory for static files and their compressed variants, files that don't fit are read from disk, 0 turns the cache off (256 by default)");
 
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -95,10 +153,51 @@ void RunWorkers(unsigned threads_count, const Fn& fn) {
     if (!vm.contains("save-state-period")) args.autosave_period = -1;
     args.random_position = vm.contains("randomize-spawn-points");
     args.no_tick_period = !vm.contains("tick-period");
+    args.db_lazy_connect = vm.contains("db-lazy-connect");
+    args.save_compress = vm.contains("save-compress");
+    args.io_per_core = vm.contains("io-per-core");
+    args.pin_threads = vm.contains("pin-threads");
+    if (args.pin_threads && !args.io_per_core) throw std::runtime_error("Thread pinning requires --io-per-core");
+    if (args.db_schema != "plain" && args.db_schema != "partitioned") throw std::runtime_error("Unknown database schema mode: " + args.db_schema);
+    if (!args.journal_path.empty() && args.save_file_path.empty()) throw std::runtime_error("Journal requires a state file");
+    if (args.save_fsync != "none" && args.save_fsync != "file" && args.save_fsync != "full") throw std::runtime_error("Unknown save fsync policy: " + args.save_fsync);
+    if (args.save_generations == 0) throw std::runtime_error("At least one save generation is required");
+    if (args.keep_alive_timeout <= 0) throw std::runtime_error("Keep-alive timeout must be positive");
+    if (args.log_sample_rate == 0) throw std::runtime_error("Log sample rate must be positive");
 
     return args;
 }
 
+save_manager::FsyncPolicy ParseFsyncPolicy(std::string_view policy) {
+    if (policy == "none"sv) {
+        return save_manager::FsyncPolicy::none;
+    }
+
+    return policy == "file"sv ? save_manager::FsyncPolicy::file : save_manager::FsyncPolicy::full;
+}
+
+// Compressed saves are inflated first, both formats are recognized by their first bytes
+snapshot::Checkpoint LoadSaveFile(const std::string & path, model::Game & game) {
+    save_manager::MappedFile save_file(path);
+
+    std::string_view data = save_file.Data();
+    std::string inflated;
+
+    if (save_manager::IsCompressed(data)) {
+        inflated = save_manager::Decompress(data);
+        data = inflated;
+    }
+
+//  *   Save files of older versions are text archives
+    if (snapshot::IsSnapshot(data)) {
+        return snapshot::DeserializeGame(data, game);
+    }
+
+    serializer::DeserializeGame(data, game);
+
+    return {};
+}
+
 }  // namespace
 
 int main(int argc, const char* argv[]) {
@@ -112,12 +211,43 @@ int main(int argc, const char* argv[]) {
 //  *   LOGGING SETUP
         SetupConsoleLogging();
 
+//  *   Requests are logged by a background writer, IO threads only fill their buffers
+        access_log::Logger::Instance().Start(access_log::Logger::Config{
+            .buffer_size = args->log_buffer_size,
+            .sample_rate = args->log_sample_rate
+        });
+
 //  *   LOAD GAME CONFIG
         std::shared_ptr<model::Game> game = std::make_shared<model::Game>(json_loader::LoadGame(args->config_file));
 
-        if (!args->save_file_path.empty() && fs::is_regular_file(args->save_file_path)) {
-            std::string serialized_data = save_manager::LoadSavedFile(args->save_file_path);
-            serializer::DeserializeGame(serialized_data, *game);
+        snapshot::Checkpoint checkpoint;
+
+//  *   A damaged save fails its checks before the game is modified, then the previous generation is tried
+        if (!args->save_file_path.empty()) {
+            std::exception_ptr load_error;
+
+            for (const std::string & path : save_manager::GetGenerationPaths(args->save_file_path, args->save_generations)) {
+                if (!fs::is_regular_file(path)) {
+                    continue;
+                }
+
+                try {
+                    checkpoint = LoadSaveFile(path, *game);
+                    load_error = nullptr;
+                    break;
+                } catch (const std::exception & ex) {
+                    BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{"exception", ex.what()}, {"where", "load"}, {"file", path}}) << logging::add_value(message_, "error");
+                    load_error = std::current_exception();
+
+//  *   *   *   Players restored before the failure must not leak into the next generation
+                    app::PlayersManager::Instance().Clear();
+                    game = std::make_shared<model::Game>(json_loader::LoadGame(args->config_file));
+                }
+            }
+
+            if (load_error) {
+                std::rethrow_exception(load_error);
+            }
         }
 
         std::vector<extra_data::MapExtraData> maps_extra_data = json_loader::GetMapsExtraData(args->config_file);
@@ -127,32 +257,89 @@ int main(int argc, const char* argv[]) {
 
 // *    LOOT_GENERATOR
         loot_gen::LootGenerator lg(std::chrono::milliseconds{(int)game->GetLootSpawnPeriod()*1000}, game->GetLootSpawnProbability());
+//  *   The journal replay spawns the same loot only from the time the snapshot was taken at
+        lg.SetTimeWithoutLoot(checkpoint.time_without_loot);
 
 // *    CREATE IO CONTEXT
-        const unsigned num_threads = std::thread::hardware_concurrency();
-        net::io_context ioc(num_threads);
+        const unsigned num_threads = std::max(1u, std::thread::hardware_concurrency());
+        net::io_context ioc(args->io_per_core ? 1 : num_threads);
+
+//  *   Per core mode: every IO thread runs its own context with its own acceptor,
+//  *   ioc keeps the game strand, the ticker and the signals and requests hop to it only to change the game
+        std::vector<std::unique_ptr<net::io_context>> io_contexts;
+        if (args->io_per_core) {
+            for (unsigned i = 0; i < num_threads; ++i) {
+                io_contexts.emplace_back(std::make_unique<net::io_context>(1));
+            }
+        }
 
         std::shared_ptr<Strand> strand = std::make_shared<Strand>(net::make_strand(ioc));
 
 // *    SETUP AUTOSAVE
         app::Application application;
-        save_manager::Saver saver(std::chrono::milliseconds(args->autosave_period), [game_ptr = std::shared_ptr<model::Game>{game}, &args, strand] () {
-            if (!args->save_file_path.empty()) {
-                net::dispatch(*strand, [game_ptr = std::shared_ptr<model::Game>(game_ptr), &args] {
-                    std::string ser_data = serializer::SerializeGame(*game_ptr);
-                    save_manager::SaveToFile(args->save_file_path, ser_data);
-                });
+        application.SetDogIdleTimeThreshold(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::duration<double>(game->GetDogIdleTimeThreshold())));
+        application.SetGameTime(checkpoint.game_time);
+
+//  *   Dogs that were standing when the state was saved start idle
+        app::PlayersManager::Instance().ForEachPlayer([&application, game] (const app::Player & player) {
+            model::GameSession * session = game->GetSessionById(player.GetSessionId());
+            model::Dog * dog = session ? session->GetDogById(player.GetPlayerId()) : nullptr;
+
+            if (!dog || dog->GetSpeed() == model::Vector2{0, 0}) {
+                application.OnDogStopped(player.GetPlayerId());
             }
         });
 
+//  *   Inputs between autosaves go to the journal, an autosave is its checkpoint
+        journal::Journal journal{journal::Journal::Config{
+            .path = args->journal_path,
+            .commit_interval = std::chrono::milliseconds{args->journal_commit_interval},
+            .keep_checkpoints = args->save_generations
+        }};
+
+        save_manager::SnapshotWriter snapshot_writer{save_manager::SnapshotWriter::Config{
+            .path = args->save_file_path,
+            .compress = args->save_compress,
+            .fsync = ParseFsyncPolicy(args->save_fsync),
+            .generations = args->save_generations
+        }};
+
+//  *   The strand only copies the state, encoding and the file write run on the save thread
+        save_manager::BackgroundWriter save_writer;
+
+//  *   Saves are polled on every tick and happen on the period or after save-dirty-threshold player inputs,
+//  *   never two at a time
+        bool autosave = !args->save_file_path.empty();
+
+        save_manager::SaveScheduler save_scheduler{save_manager::SaveScheduler::Config{
+            .period = std::chrono::milliseconds{autosave ? args->autosave_period : 0},
+            .dirty_threshold = autosave ? args->save_dirty_threshold : 0
+        }, [game, &save_writer, &snapshot_writer, &application, &lg, &journal, &save_scheduler] {
+            auto state = std::make_shared<snapshot::GameState>(snapshot::CaptureGame(*game));
+            state->game_time = application.GetGameTime().count();
+            state->time_without_loot = lg.GetTimeWithoutLoot().count();
+            state->journal_sequence = journal.BeginCheckpoint();
+
+            save_writer.Submit([state, &snapshot_writer, &journal, &save_scheduler] {
+                try {
+                    snapshot_writer.Save([&state] {
+                        return snapshot::SerializeState(*state);
+                    });
+                } catch (...) {
+                    save_scheduler.Finish(false);
+                    throw;
+                }
+
+                journal.CompleteCheckpoint(state->journal_sequence);
+                save_scheduler.Finish();
+            });
+        }};
+
 //  *   SIGNALS HANDLER
         net::signal_set signal_set(ioc, SIGINT, SIGTERM);
 
-        signal_set.async_wait([&ioc, &args, &saver] (const sys::error_code & ec, int signal_number) {
-            if (!args->save_file_path.empty()) {
-                saver.Save();
-            }
-
+//  *   The state is saved once the workers have stopped
+        signal_set.async_wait([&ioc, &io_contexts] (const sys::error_code & ec, int signal_number) {
             if (ec) {
                 BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{ "code", EXIT_FAILURE }, {"exception", ec.what()}}) << logging::add_value(message_, "server exited");
             }
@@ -160,86 +347,219 @@ int main(int argc, const char* argv[]) {
             BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{ "code", 0 }}) << logging::add_value(message_, "server exited");
 
             ioc.stop();
+            for (std::unique_ptr<net::io_context> & io : io_contexts) {
+                io->stop();
+            }
         });
 
 
 //  *   INIT DB
-        std::shared_ptr<database::ConnectionPool> connection_pool = std::make_shared<database::ConnectionPool>(4u, std::getenv(DB_CONNECTION_URL_ENV_VAR));
-        std::shared_ptr<app::IUnitOfWorkFactory> unit_of_work_factory = std::make_shared<database::DbUnitOfWorkFactory>(connection_pool);
+        database::ConnectionPool::Config pool_config{
+            .size = args->db_pool_size,
+            .connect_threads = args->db_connect_threads,
+            .acquire_timeout = std::chrono::milliseconds{args->db_acquire_timeout},
+            .lazy_connect = args->db_lazy_connect,
+            .schema_mode = args->db_schema == "partitioned"sv ? database::SchemaMode::partitioned : database::SchemaMode::plain,
+            .top_results_size = args->db_top_results
+        };
+        std::shared_ptr<app::IUnitOfWorkFactory> unit_of_work_factory;
+
+//  *   A local results store replaces PostgreSQL, GAME_DB_URL is not needed then
+        if (!args->results_store_path.empty()) {
+            unit_of_work_factory = std::make_shared<results_store::LocalUnitOfWorkFactory>(std::make_shared<results_store::LocalResultsStore>(args->results_store_path));
+        } else {
+            std::shared_ptr<database::ConnectionPool> connection_pool = std::make_shared<database::ConnectionPool>(pool_config, std::getenv(DB_CONNECTION_URL_ENV_VAR));
+            unit_of_work_factory = std::make_shared<database::DbUnitOfWorkFactory>(connection_pool);
+        }
 
-//  *   SUBSCRIBE HANDLER FOR TICKER
-        application.DoOnTick([&saver, game, strand_ptr = std::shared_ptr<Strand>(strand), &unit_of_work_factory] (std::chrono::milliseconds delta_time) {
+        app::ResultsWriter results_writer(unit_of_work_factory);
+        std::shared_ptr<app::DbExecutor> db_executor = std::make_shared<app::DbExecutor>(unit_of_work_factory, pool_config.size);
+
+//  *   INIT LEADERBOARD
+//  *   Result ids continue after the stored ones, they are assigned on the game strand
+        app::Leaderboard leaderboard;
+        std::uint64_t last_result_id = 0;
+        {
             auto unit_of_work = unit_of_work_factory->NewUnitOfWork();
+            leaderboard.Seed(unit_of_work->Results()->GetResults(leaderboard.GetCapacity(), 0));
+            last_result_id = unit_of_work->Results()->GetLastResultId();
+            unit_of_work->Commit();
+        }
+
+//  *   SUBSCRIBE HANDLER FOR TICKER
+//  *   While the journal is replayed, retired players are already in the results and the state is not saved
+        bool replaying = false;
 
+        application.DoOnTick([&save_scheduler, &application, game, strand_ptr = std::shared_ptr<Strand>(strand), &results_writer, &leaderboard, &last_result_id, &journal, &replaying] (std::chrono::milliseconds delta_time) {
+//  *   *   Dogs stopped by a road edge during the previous update have been idle since then
             for (model::GameSession & session : game->GetSessions()) {
-                std::vector<int> dogs_to_delete;
-
-                for (model::Dog & dog : session.GetDogs()) {
-                    app::Player * player = app::PlayersManager::Instance().GetPlayerById(dog.GetId());
-                    player->AddPlayingTime(delta_time);
-                    if (dog.GetSpeed() == model::Vector2{0, 0}) {
-                        player->AddIdleTime(delta_time);
-
-                        if (player->GetIdleTime() >= std::chrono::duration<double>(game->GetDogIdleTimeThreshold())) {
-                            app::GameResult result{player->GetPlayerName(), player->GetScores(), static_cast<unsigned int>(player->GetPlayingTime().count())};
-                            unit_of_work->Results()->AddResult(result);
-
-                            dogs_to_delete.emplace_back(player->GetPlayerId());
-                            app::PlayersManager::Instance().RemovePlayer(player->GetPlayerId());
-                        }
-                    } else {
-                        player->ResetIdleTime();
+                for (unsigned int dog_id : session.TakeStoppedDogs()) {
+                    model::Dog * dog = session.GetDogById(dog_id);
+
+                    if (dog && dog->GetSpeed() == model::Vector2{0, 0}) {
+                        application.OnDogStopped(dog_id, application.GetGameTime() - delta_time);
                     }
                 }
+            }
 
-                for (int & dog_id : dogs_to_delete) {
-                    session.RemoveDogById(dog_id);
+            application.ForEachRetiredDog([game, &application, &results_writer, &leaderboard, &last_result_id, &journal, &replaying] (int player_id) {
+                std::shared_ptr<app::Player> player = app::PlayersManager::Instance().GetPlayerById(player_id);
+
+                if (!player) {
+                    return;
+                }
+
+                if (!replaying) {
+                    app::GameResult result{player->GetPlayerName(), player->GetScores(), static_cast<unsigned int>(player->GetPlayingTime(application.GetGameTime()).count()), ++last_result_id};
+
+                    leaderboard.Add(result);
+                    results_writer.Push(std::move(result));
+                    journal.Append(journal::RetireRecord{player_id});
+                }
+
+                if (model::GameSession * session = game->GetSessionById(player->GetSessionId())) {
+                    session->RemoveDogById(player_id);
                 }
+                app::PlayersManager::Instance().RemovePlayer(player_id);
+            });
+
+            if (!replaying) {
+                save_scheduler.Poll(journal.GetInputCount());
             }
+        });
 
-            unit_of_work->Commit();
+//  *   Advances the game, the ticker and the journal replay share it
+        auto tick_game = [game, &application, &lg] (int interval) {
+            application.Tick(std::chrono::milliseconds(interval));
+            game->Tick(interval, [game, &lg, interval] {
+                for (model::GameSession & session : game->GetSessions()) {
+//  *   *   *   *   Generate new items on the session map
+                    unsigned int spawned_items = lg.Generate(std::chrono::milliseconds(interval), session.GetItems().size(), session.GetDogs().size()); 
+                    session.AddItems(spawned_items);
+
+                    collision_detector::UpdateSessionItems(session, interval);
+                }
+            });
+        };
+
+//  *   REPLAY JOURNAL
+        replaying = true;
+        journal.Recover(checkpoint.journal_sequence, [game, &application, &tick_game] (const journal::Record & record) {
+            app::PlayersManager & players_manager = app::PlayersManager::Instance();
+
+            if (const auto * join = std::get_if<journal::JoinRecord>(&record)) {
+                model::Map * map = const_cast<model::Map *>(game->FindMap(model::Map::Id{join->map_id}));
+                if (!map) {
+                    throw std::runtime_error("Journal refers to an unknown map: " + join->map_id);
+                }
+
+                model::GameSession * session = game->NewSession(map);
+                session->GetDogs().emplace_back(join->player_id, model::Vector2{join->x, join->y});
 
-            saver.Save(delta_time);
+                players_manager.AddPlayer(std::make_shared<app::Player>(join->token, join->player_id, join->name, session->GetId(), std::chrono::milliseconds{join->join_time}));
+                players_manager.SetNextPlayerId(std::max(players_manager.GetNextPlayerId(), join->player_id + 1));
+                application.OnDogStopped(join->player_id);
+            } else if (const auto * move = std::get_if<journal::MoveRecord>(&record)) {
+                std::shared_ptr<app::Player> player = players_manager.GetPlayerById(move->player_id);
+                model::GameSession * session = player ? game->GetSessionById(player->GetSessionId()) : nullptr;
+                model::Dog * dog = session ? session->GetDogById(move->player_id) : nullptr;
+
+                if (dog) {
+                    application.MoveDog(*session, *dog, move->direction);
+                }
+            } else if (const auto * tick = std::get_if<journal::TickRecord>(&record)) {
+                RandomGenerator::Seed(tick->seed);
+                tick_game(static_cast<int>(tick->delta));
+            } else if (const auto * retire = std::get_if<journal::RetireRecord>(&record)) {
+//  *   *   *   The replayed ticks retire the same dogs, a dog still here is removed as it was
+                if (std::shared_ptr<app::Player> player = players_manager.GetPlayerById(retire->player_id)) {
+                    application.OnDogMoved(retire->player_id);
+
+                    if (model::GameSession * session = game->GetSessionById(player->GetSessionId())) {
+                        session->RemoveDogById(retire->player_id);
+                    }
+                    players_manager.RemovePlayer(retire->player_id);
+                }
+            }
         });
+        replaying = false;
+
+//  *   STATIC FILES CACHE
+//  *   Files are loaded and compressed before the server starts, changed ones are reloaded on request
+        static_cache::StaticCache static_cache{root, static_cache::StaticCache::Config{
+            .max_total_size = args->static_cache_size * 1024 * 1024
+        }};
+        static_cache.Preload();
+
+//  *   WebSocket subscribers get the state after every tick, it is used on the strand only
+        http_handler::StatePublisher state_publisher;
 
 //  *   CREATE REQUEST HANDLER
-        http_handler::RequestHandler handler{game, application, lg, unit_of_work_factory, maps_extra_data, strand, root};
+        http_handler::RequestHandler handler{game, application, lg, db_executor, leaderboard, journal, maps_extra_data, strand, root, static_cache, state_publisher};
 
 //  *   LISTEN AND WAIT FOR NEW CONNECTION
         const auto address = net::ip::make_address("0.0.0.0");
         constexpr net::ip::port_type port = 8080;
 
-        http_server::ServeHttp(ioc, {address, port}, [&handler, &ioc](auto&& req, auto&& send) {
+//  *   Connections are kept alive and may pipeline requests, responses go out in request order
+        http_server::SessionBase::Config session_config{
+            .idle_timeout = std::chrono::milliseconds{args->keep_alive_timeout},
+            .max_requests = args->keep_alive_max_requests
+        };
+
+        auto serve = [&handler] (auto&& req, auto&& send) {
             handler(std::move(req), send);
-        });
+        };
+
+        if (io_contexts.empty()) {
+            http_server::ServeHttp(ioc, {address, port}, serve, session_config);
+        } else {
+            for (std::unique_ptr<net::io_context> & io : io_contexts) {
+                http_server::ServeHttp(*io, {address, port}, serve, session_config, true);
+            }
+        }
 
 //  *   TICKER
         if (!args->no_tick_period) {
-            std::make_shared<ticker::Ticker>(ticker::Ticker(strand, std::chrono::milliseconds(args->tick_period), [game, &application, &lg] (int interval) {
-                application.Tick(std::chrono::milliseconds(interval));
-                game->Tick(interval, [game, &lg, interval] {
-                    for (model::GameSession & session : game->GetSessions()) {
-//  *   *   *   *   *   Generate new items on the session map
-                        unsigned int spawned_items = lg.Generate(std::chrono::milliseconds(interval), session.GetItems().size(), session.GetDogs().size()); 
-                        session.AddItems(spawned_items);
-
-                        collision_detector::UpdateSessionItems(session, interval);
-                    }
-                });
+            std::make_shared<ticker::Ticker>(ticker::Ticker(strand, std::chrono::milliseconds(args->tick_period), [&journal, &tick_game, &state_publisher, game] (int interval) {
+                std::uint32_t seed = RandomGenerator::NewSeed();
+                journal.Append(journal::TickRecord{interval, seed});
+                RandomGenerator::Seed(seed);
+
+                tick_game(interval);
+                state_publisher.Publish(*game);
             }))->Start();
 
         }
         
         BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{"address", address.to_string() }, { "port", port }}) << logging::add_value(message_, "server started");
 
-        RunWorkers(std::max(1u, num_threads), [&ioc] {
-            ioc.run();
-        });
+        if (io_contexts.empty()) {
+            RunWorkers(num_threads, [&ioc] {
+                ioc.run();
+            });
+        } else {
+            RunPerCore(ioc, io_contexts, args->pin_threads);
+        }
+
+//  *   A background save still in flight must not overwrite the final one
+        save_writer.Stop();
 
         if (!args->save_file_path.empty()) {
-            std::string ser_data = serializer::SerializeGame(*game);
-            save_manager::SaveToFile(args->save_file_path, ser_data);
+            snapshot::GameState state = snapshot::CaptureGame(*game);
+            state.game_time = application.GetGameTime().count();
+            state.time_without_loot = lg.GetTimeWithoutLoot().count();
+            state.journal_sequence = journal.BeginCheckpoint();
+
+            snapshot_writer.Save([&state] {
+                return snapshot::SerializeState(state);
+            });
+            journal.CompleteCheckpoint(state.journal_sequence);
         }
+
+        journal.Stop();
+        results_writer.Stop();
+        access_log::Logger::Instance().Stop();
     } catch (const std::exception& ex) {
         std::cerr << ex.what() << std::endl;
         return EXIT_FAILURE;
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+namespace metrics {
+
+class Counter {
+public:
+    void Increment(std::uint64_t value = 1) noexcept {
+        value_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    std::uint64_t Get() const noexcept {
+        return value_.load(std::memory_order_relaxed);
+    }
+private:
+    std::atomic<std::uint64_t> value_ = 0;
+};
+
+class Gauge {
+public:
+    void Set(std::int64_t value) noexcept {
+        value_.store(value, std::memory_order_relaxed);
+    }
+
+    void Add(std::int64_t value = 1) noexcept {
+        value_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void Sub(std::int64_t value = 1) noexcept {
+        value_.fetch_sub(value, std::memory_order_relaxed);
+    }
+
+    std::int64_t Get() const noexcept {
+        return value_.load(std::memory_order_relaxed);
+    }
+private:
+    std::atomic<std::int64_t> value_ = 0;
+};
+
+// Count, sum and maximum of observed durations
+class Timing {
+public:
+    void Observe(std::chrono::nanoseconds duration) noexcept {
+        std::uint64_t ns = static_cast<std::uint64_t>(std::max(duration.count(), std::chrono::nanoseconds::rep{0}));
+
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+
+        std::uint64_t max = max_ns_.load(std::memory_order_relaxed);
+        while (max < ns && !max_ns_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::uint64_t GetCount() const noexcept {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    double GetSumSeconds() const noexcept {
+        return static_cast<double>(sum_ns_.load(std::memory_order_relaxed)) / 1e9;
+    }
+
+    double GetMaxSeconds() const noexcept {
+        return static_cast<double>(max_ns_.load(std::memory_order_relaxed)) / 1e9;
+    }
+private:
+    std::atomic<std::uint64_t> count_ = 0;
+    std::atomic<std::uint64_t> sum_ns_ = 0;
+    std::atomic<std::uint64_t> max_ns_ = 0;
+};
+
+// Process wide set of named metrics.
+// Components look their metrics up once and keep the references, updates are lock free.
+class Registry {
+public:
+    static Registry & Instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    Registry(const Registry &) = delete;
+    Registry & operator=(const Registry &) = delete;
+
+    Counter & GetCounter(const std::string & name) {
+        return Get(counters_, name);
+    }
+
+    Gauge & GetGauge(const std::string & name) {
+        return Get(gauges_, name);
+    }
+
+    Timing & GetTiming(const std::string & name) {
+        return Get(timings_, name);
+    }
+
+    // Prometheus text exposition format
+    std::string Format() const {
+        std::lock_guard lock{m_};
+        std::ostringstream out;
+
+        for (const auto & [name, counter] : counters_) {
+            out << "# TYPE " << name << " counter\n" << name << ' ' << counter->Get() << '\n';
+        }
+
+        for (const auto & [name, gauge] : gauges_) {
+            out << "# TYPE " << name << " gauge\n" << name << ' ' << gauge->Get() << '\n';
+        }
+
+        for (const auto & [name, timing] : timings_) {
+            out << "# TYPE " << name << " summary\n"
+                << name << "_count " << timing->GetCount() << '\n'
+                << name << "_sum " << timing->GetSumSeconds() << '\n'
+                << name << "_max " << timing->GetMaxSeconds() << '\n';
+        }
+
+        return out.str();
+    }
+
+private:
+    Registry() = default;
+
+    template <typename Metric>
+    Metric & Get(std::map<std::string, std::unique_ptr<Metric>> & metrics, const std::string & name) {
+        std::lock_guard lock{m_};
+
+        auto [it, inserted] = metrics.try_emplace(name);
+        if (inserted) {
+            it->second = std::make_unique<Metric>();
+        }
+
+        return *it->second;
+    }
+
+    mutable std::mutex m_;
+    std::map<std::string, std::unique_ptr<Counter>> counters_;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges_;
+    std::map<std::string, std::unique_ptr<Timing>> timings_;
+};
+
+} // namespace metrics
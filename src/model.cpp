@@ -145,7 +145,10 @@ void GameSession::Update(unsigned int delta_time) {
         }
 
         dog.SetPosition(position);
-    
+
+        if (speed != Vector2{0, 0} && dog.GetSpeed() == Vector2{0, 0}) {
+            stopped_dogs_.emplace_back(dog.GetId());
+        }
     }
 }
 
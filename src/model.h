@@ -8,6 +8,7 @@
 #include <iostream>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "tagged.h"
@@ -411,7 +412,7 @@ public:
         position.y = map_->GetRoads().front().GetStart().y;
         
         if (random_position_) {
-            Road picked_road = map_->GetRoads().at(std::rand()%map_->GetRoads().size());
+            Road picked_road = map_->GetRoads().at(RandomGenerator::GenerateUpTo(map_->GetRoads().size() - 1));
 
             if (picked_road.IsHorizontal()) {
                 double x = picked_road.GetStart().x+(picked_road.GetEnd().x-picked_road.GetStart().x)*RandomGenerator::GenerateUpTo(100)/100;
@@ -453,8 +454,8 @@ public:
 
     void AddItems(int count) {
         for (int i = 0; i < count; ++i) {
-            int picked_item_type = std::rand()%map_->GetItemsTypes().size();
-            Road picked_road = map_->GetRoads().at(std::rand()%map_->GetRoads().size());
+            int picked_item_type = RandomGenerator::GenerateUpTo(map_->GetItemsTypes().size() - 1);
+            Road picked_road = map_->GetRoads().at(RandomGenerator::GenerateUpTo(map_->GetRoads().size() - 1));
 
             Point position{0, 0};
 
@@ -490,9 +491,15 @@ public:
 
     void Update(unsigned int delta_time);
 
+    // Ids of dogs that were stopped by a road edge since the previous call
+    std::vector<unsigned int> TakeStoppedDogs() {
+        return std::exchange(stopped_dogs_, {});
+    }
+
 private:
     unsigned int id_ = 0;
     Dogs dogs_{};
+    std::vector<unsigned int> stopped_dogs_{};
     Map * map_;
     Items items_{};
     bool random_position_;
@@ -1,7 +1,7 @@
-#pragma once
-
-namespace model {
-
-static constexpr double ROAD_WIDTH = 0.8;
-
+#pragma once
+
+namespace model {
+
+static constexpr double ROAD_WIDTH = 0.8;
+
 } //namespace model
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "move_message.h"
+
+#include <boost/json.hpp>
+
+namespace http_handler {
+
+namespace json = boost::json;
+
+std::optional<model::Direction> ParseMove(std::string_view move) {
+    if (move == "L") {
+        return model::Direction::WEST;
+    } else if (move == "R") {
+        return model::Direction::EAST;
+    } else if (move == "U") {
+        return model::Direction::NORTH;
+    } else if (move == "D") {
+        return model::Direction::SOUTH;
+    } else if (move == "") {
+        return model::Direction::ZERO;
+    }
+
+    return std::nullopt;
+}
+
+std::optional<model::Direction> ParseMoveMessage(std::string_view message) {
+    boost::system::error_code ec;
+    json::value val = json::parse(message, ec);
+
+    if (ec || !val.is_object() || !val.as_object().contains("move") || !val.at("move").is_string()) {
+        return std::nullopt;
+    }
+
+    return ParseMove(val.at("move").as_string());
+}
+
+} // namespace http_handler
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+#include "model.h"
+
+namespace http_handler {
+
+// "L", "R", "U", "D" or "" to stop, nullopt for any other value
+std::optional<model::Direction> ParseMove(std::string_view move);
+
+// {"move": "<direction>"} message of a WebSocket client, nullopt if it is malformed
+std::optional<model::Direction> ParseMoveMessage(std::string_view message);
+
+} // namespace http_handler
@@ -1,14 +1,29 @@
-#pragma once
-
-#include <random>
-#include <ctime>
-
-class RandomGenerator {
-public:
-    static int GenerateUpTo(int roof) {
-        std::srand(std::time(0));
-        return std::rand()%(roof+1);
-    }
-private:
-    RandomGenerator() {}
-};
\ No newline at end of file
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+// Game randomness (spawn points, lost items) comes from one engine that is only used on the game strand.
+// Every tick reseeds it with a seed kept in the action journal, so a replayed tick spawns the same items.
+class RandomGenerator {
+public:
+    static int GenerateUpTo(int roof) {
+        return std::uniform_int_distribution<int>{0, roof}(Engine());
+    }
+
+    static void Seed(std::uint32_t seed) {
+        Engine().seed(seed);
+    }
+
+    static std::uint32_t NewSeed() {
+        static std::random_device device;
+        return device();
+    }
+private:
+    RandomGenerator() {}
+
+    static std::mt19937 & Engine() {
+        static std::mt19937 engine{std::random_device{}()};
+        return engine;
+    }
+};
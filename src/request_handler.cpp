@@ -1,5 +1,6 @@
 #include "request_handler.h"
 
+#include <algorithm>
 #include <string>
 
 namespace http_handler {
@@ -19,23 +20,142 @@ HttpFileResponse ConstructFileResponse (fs::path root, fs::path request_target,
     
     root += request_target;
 
-    http::file_body::value_type file;
-
     HttpFileResponse response(http::status::ok, version);
     response.keep_alive(keep_alive);
 
-    file.open(root.c_str(), beast::file_mode::read, ec);
+//  *   A directory would open as well, its content can't be sent
+    if (std::error_code fs_ec; !fs::is_regular_file(root, fs_ec)) {
+        ec = sys::errc::make_error_code(sys::errc::no_such_file_or_directory);
+        return response;
+    }
+
+    response.body().Open(root.c_str(), ec);
 
     response.set(http::field::content_type, http_content_type::GetContentTypeByExtension({root.extension().c_str()}));
-    response.body() = std::move(file);
     response.prepare_payload();
 
     return response;
 }
 
+// RESPONSE: CACHED STATIC FILE
+//  *   A matching If-None-Match gives 304, a single byte range of the identity content gives 206 or 416.
+//  *   Range requests are answered without compression, other requests get the best variant the client accepts.
+HttpAssetResponse ConstructAssetResponse(static_cache::AssetPtr asset, const http::fields & request_fields, unsigned version, bool keep_alive) {
+    using static_cache::Encoding;
+
+    HttpAssetResponse response(http::status::ok, version);
+    response.keep_alive(keep_alive);
+
+    std::string_view range = request_fields[http::field::range];
+    std::string_view if_range = request_fields[http::field::if_range];
+
+    if (!if_range.empty() && if_range != asset->identity.etag) {
+        range = {};
+    }
+
+    Encoding encoding = Encoding::IDENTITY;
+    if (range.empty()) {
+        std::string_view accept_encoding = request_fields[http::field::accept_encoding];
+
+        if (asset->HasVariant(Encoding::GZIP) && http_utils::AcceptsEncoding(accept_encoding, "gzip"sv)) {
+            encoding = Encoding::GZIP;
+        } else if (asset->HasVariant(Encoding::DEFLATE) && http_utils::AcceptsEncoding(accept_encoding, "deflate"sv)) {
+            encoding = Encoding::DEFLATE;
+        }
+    }
+
+    const static_cache::Asset::Variant & variant = asset->GetVariant(encoding);
+
+    response.set(http::field::etag, variant.etag);
+    response.set(http::field::cache_control, "no-cache");
+    if (asset->HasVariant(Encoding::GZIP) || asset->HasVariant(Encoding::DEFLATE)) {
+        response.set(http::field::vary, "Accept-Encoding");
+    }
+
+    if (std::string_view if_none_match = request_fields[http::field::if_none_match]; !if_none_match.empty() && http_utils::MatchesEtag(if_none_match, variant.etag)) {
+        response.result(http::status::not_modified);
+        return response;
+    }
+
+    response.set(http::field::content_type, asset->content_type);
+    response.set(http::field::accept_ranges, "bytes");
+
+    if (encoding == Encoding::GZIP) {
+        response.set(http::field::content_encoding, "gzip");
+    } else if (encoding == Encoding::DEFLATE) {
+        response.set(http::field::content_encoding, "deflate");
+    }
+
+    std::string_view data = variant.data;
+
+    if (std::optional<http_utils::ByteRange> byte_range = range.empty() ? std::nullopt : http_utils::ParseRange(range, data.size())) {
+        std::string content_range = "bytes "s;
+
+        if (byte_range->satisfiable) {
+            response.result(http::status::partial_content);
+            content_range += std::to_string(byte_range->first) + "-" + std::to_string(byte_range->last);
+            data = data.substr(byte_range->first, byte_range->last - byte_range->first + 1);
+        } else {
+            response.result(http::status::range_not_satisfiable);
+            content_range += "*";
+            data = {};
+        }
+
+        response.set(http::field::content_range, content_range + "/" + std::to_string(variant.data.size()));
+    }
+
+    response.body() = {std::move(asset), data};
+    response.prepare_payload();
+
+    return response;
+}
+
+//  *   The headers of a cached response with the body taken from the asset file. The file is checked by its size only,
+//  *   a changed file is reloaded by the cache within its check interval
+std::optional<HttpFileResponse> ConstructFileResponse(const HttpAssetResponse & asset_response) {
+    const static_cache::AssetPtr & asset = asset_response.body().asset;
+    std::string_view data = asset_response.body().data;
+
+    HttpFileResponse response{asset_response.base()};
+
+    sys::error_code ec;
+    response.body().Open(asset->path.c_str(), ec);
+
+    if (ec || response.body().GetSize() != asset->identity.data.size()) {
+        return std::nullopt;
+    }
+
+    response.body().SetRange(static_cast<std::uint64_t>(data.data() - asset->identity.data.data()), data.size());
+
+    return response;
+}
+
+static_cache::AssetPtr RequestHandler::BuildMapsResponse(const model::Game & game) {
+    return std::make_shared<const static_cache::Asset>(static_cache::StaticCache::MakeAsset(".json"sv, json_builder::GetMaps_s(game.GetMaps()), static_cache::StaticCache::Config{}.min_compress_size));
+}
+
+//  *   A map without extra data in the config gets no loot types
+RequestHandler::MapResponses RequestHandler::BuildMapResponses(const model::Game & game, const std::vector<extra_data::MapExtraData> & maps_extra_data) {
+    MapResponses responses;
+
+    for (const model::Map & map : game.GetMaps()) {
+        auto extra_data = std::find_if(maps_extra_data.begin(), maps_extra_data.end(), [&map] (const extra_data::MapExtraData & ed) {
+            return ed.GetMapId() == *map.GetId();
+        });
+
+        std::string body = extra_data != maps_extra_data.end()
+            ? json_builder::GetMapWithExtraData_s(map, *extra_data)
+            : json_builder::GetMapWithExtraData_s(map, extra_data::MapExtraData{*map.GetId(), json::array{}});
+
+        responses.emplace(*map.GetId(), std::make_shared<const static_cache::Asset>(static_cache::StaticCache::MakeAsset(".json"sv, std::move(body), static_cache::StaticCache::Config{}.min_compress_size)));
+    }
+
+    return responses;
+}
+
 // RESPONSE: OK
 HttpResponse ConstructOkResponse(unsigned version, bool keep_alive) {
-    HttpResponse response = ConstructJsonResponse(http::status::ok, version);
+    HttpResponse response = ConstructJsonResponse(http::status::ok, version, keep_alive);
     response.set(http::field::cache_control, "no-cache");
 
     return response;
@@ -50,7 +170,7 @@ HttpResponse ConstructOkResponse(std::string_view body, unsigned version, bool k
 
 // RESPONSE: METHOD NOT ALLOWED
 HttpResponse ConstructMethodNotAllowedResponse (std::string_view methods, unsigned version, bool keep_alive) {
-    HttpResponse response = ConstructJsonResponse(http::status::method_not_allowed, version);
+    HttpResponse response = ConstructJsonResponse(http::status::method_not_allowed, version, keep_alive);
     response.set(http::field::allow, methods);
     response.set(http::field::cache_control, "no-cache");
     response.body() = json_builder::GetMethodNotAllowed_s(methods);
@@ -61,7 +181,7 @@ HttpResponse ConstructMethodNotAllowedResponse (std::string_view methods, unsign
 
 // RESPONSE: INVALID ARGUMENT
 HttpResponse ConstructInvalidArgumentResponse(std::string_view msg, unsigned version, bool keep_alive) {
-    HttpResponse response{ConstructJsonResponse(http::status::bad_request, version)};
+    HttpResponse response{ConstructJsonResponse(http::status::bad_request, version, keep_alive)};
     response.set(http::field::cache_control, "no-cache");
     response.body() = json_builder::GetInvalidArgument_s(msg);
     response.prepare_payload();
@@ -71,7 +191,7 @@ HttpResponse ConstructInvalidArgumentResponse(std::string_view msg, unsigned ver
 
 // RESPONSE: MAP NOT FOUNDs
 HttpResponse ConstructMapNotFoundResponse(unsigned version, bool keep_alive) {
-    HttpResponse response = ConstructJsonResponse(http::status::not_found, version);
+    HttpResponse response = ConstructJsonResponse(http::status::not_found, version, keep_alive);
     response.set(http::field::cache_control, "no-cache");
     response.body() = json_builder::GetMapNotFound_s();
     response.prepare_payload();
@@ -79,7 +199,7 @@ HttpResponse ConstructMapNotFoundResponse(unsigned version, bool keep_alive) {
     return response;
 }
 HttpResponse ConstructMapNotFoundResponse_head(unsigned version, bool keep_alive) {
-    HttpResponse response = ConstructJsonResponse(http::status::not_found, version);
+    HttpResponse response = ConstructJsonResponse(http::status::not_found, version, keep_alive);
     response.set(http::field::cache_control, "no-cache");
     response.prepare_payload();
 
@@ -88,7 +208,7 @@ HttpResponse ConstructMapNotFoundResponse_head(unsigned version, bool keep_alive
 
 // RESPONSE: BAD REQUEST
 HttpResponse ConstructBadRequestResponse(std::string_view body, unsigned version, bool keep_alive) {
-    HttpResponse response = ConstructJsonResponse(http::status::bad_request, version);
+    HttpResponse response = ConstructJsonResponse(http::status::bad_request, version, keep_alive);
     response.set(http::field::cache_control, "no-cache");
     response.body() = body;
     response.prepare_payload();
@@ -97,7 +217,7 @@ HttpResponse ConstructBadRequestResponse(std::string_view body, unsigned version
 }
 
 HttpResponse ConstructBadRequestResponse(unsigned version, bool keep_alive) {
-    HttpResponse response = ConstructJsonResponse(http::status::bad_request, version);
+    HttpResponse response = ConstructJsonResponse(http::status::bad_request, version, keep_alive);
     response.set(http::field::cache_control, "no-cache");
     response.prepare_payload();
 
@@ -106,7 +226,7 @@ HttpResponse ConstructBadRequestResponse(unsigned version, bool keep_alive) {
 
 // RESPONSE: UNAUTHORIZED
 HttpResponse ConstructUnauthorizedResponse(std::string_view body, unsigned version, bool keep_alive) {
-    HttpResponse response = ConstructJsonResponse(http::status::unauthorized, version);
+    HttpResponse response = ConstructJsonResponse(http::status::unauthorized, version, keep_alive);
     response.set(http::field::cache_control, "no-cache");
     response.body() = body;
     response.prepare_payload();
@@ -114,8 +234,44 @@ HttpResponse ConstructUnauthorizedResponse(std::string_view body, unsigned versi
     return response;
 }
 HttpResponse ConstructUnauthorizedResponse(unsigned version, bool keep_alive) {
-    HttpResponse response = ConstructJsonResponse(http::status::unauthorized, version);
+    HttpResponse response = ConstructJsonResponse(http::status::unauthorized, version, keep_alive);
+    response.set(http::field::cache_control, "no-cache");
+    response.prepare_payload();
+
+    return response;
+}
+
+// RESPONSE: SERVICE UNAVAILABLE
+HttpResponse ConstructServiceUnavailableResponse(std::string_view msg, unsigned version, bool keep_alive) {
+    HttpResponse response = ConstructJsonResponse(http::status::service_unavailable, version, keep_alive);
+    response.set(http::field::cache_control, "no-cache");
+    response.set(http::field::retry_after, "1");
+    response.body() = json_builder::GetServiceUnavailable_s(msg);
+    response.prepare_payload();
+
+    return response;
+}
+
+// RESPONSE: RECORDS
+HttpResponse ConstructRecordsResponse(const std::vector<app::GameResult> & results, unsigned int max_items, bool with_cursor, unsigned version, bool keep_alive) {
+    HttpResponse response = ConstructOkResponse(json_builder::GetTopGameResults_s(results), version, keep_alive);
+
+//  *   A full page may have a continuation
+    if (with_cursor && max_items > 0 && results.size() == max_items) {
+        const app::GameResult & last = results.back();
+        response.set("X-Next-Cursor"sv, app::FormatResultsCursor({last.scores_, last.session_duration_, last.id_, last.name_}));
+    }
+
+    return response;
+}
+
+// RESPONSE: METRICS
+HttpResponse ConstructMetricsResponse(unsigned version, bool keep_alive) {
+    HttpResponse response(http::status::ok, version);
+    response.keep_alive(keep_alive);
+    response.set(http::field::content_type, "text/plain; version=0.0.4");
     response.set(http::field::cache_control, "no-cache");
+    response.body() = metrics::Registry::Instance().Format();
     response.prepare_payload();
 
     return response;
@@ -14,6 +14,8 @@
 #include <syncstream>
 #include <iostream>
 #include <chrono>
+#include <limits>
+#include <map>
 #include <string>
 
 #include "model.h"
@@ -23,10 +25,19 @@
 #include "http_server.h"
 #include "json_builder.h"
 #include "json_loader.h"
-#include "endpoint.h"
+#include "router.h"
 #include "http_utils.h"
 #include "http_content_type.h"
 #include "extra_data.h"
+#include "leaderboard.h"
+#include "db_executor.h"
+#include "metrics.h"
+#include "journal.h"
+#include "random_generator.h"
+#include "static_cache.h"
+#include "state_publisher.h"
+#include "move_message.h"
+#include "logger.h"
 
 namespace http_handler {
 
@@ -39,12 +50,15 @@ namespace json = boost::json;
 using namespace std::literals;
 
 using HttpResponse = http::response<http::string_body>;
-using HttpFileResponse = http::response<http::file_body>;
+using HttpFileResponse = http::response<http_server::SendfileBody>;
+using HttpAssetResponse = http::response<static_cache::AssetBody>;
 
 namespace fs = std::filesystem;
 
-HttpResponse ConstructJsonResponse (http::status status, unsigned version, bool keep_alive = false);
+HttpResponse ConstructJsonResponse (http::status status, unsigned version, bool keep_alive);
 HttpFileResponse ConstructFileResponse (fs::path root, fs::path request_target, unsigned version, bool keep_alive, sys::error_code & ec);
+HttpAssetResponse ConstructAssetResponse(static_cache::AssetPtr asset, const http::fields & request_fields, unsigned version, bool keep_alive);
+std::optional<HttpFileResponse> ConstructFileResponse(const HttpAssetResponse & asset_response);
 HttpResponse ConstructOkResponse(unsigned version, bool keep_alive);
 HttpResponse ConstructOkResponse(std::string_view body, unsigned version, bool keep_alive);
 HttpResponse ConstructMethodNotAllowedResponse (std::string_view methods, unsigned version, bool keep_alive);
@@ -55,719 +69,724 @@ HttpResponse ConstructBadRequestResponse(std::string_view body, unsigned version
 HttpResponse ConstructBadRequestResponse(unsigned version, bool keep_alive);
 HttpResponse ConstructUnauthorizedResponse(std::string_view body, unsigned version, bool keep_alive);
 HttpResponse ConstructUnauthorizedResponse(unsigned version, bool keep_alive);
+HttpResponse ConstructServiceUnavailableResponse(std::string_view msg, unsigned version, bool keep_alive);
+HttpResponse ConstructMetricsResponse(unsigned version, bool keep_alive);
+HttpResponse ConstructRecordsResponse(const std::vector<app::GameResult> & results, unsigned int max_items, bool with_cursor, unsigned version, bool keep_alive);
 
 class RequestHandler {
 public:
     using Strand = net::strand<net::io_context::executor_type>;
+    using TimePoint = std::chrono::time_point<std::chrono::system_clock>;
 
-    RequestHandler(std::shared_ptr<model::Game> game, app::Application & application, loot_gen::LootGenerator& generator, std::shared_ptr<app::IUnitOfWorkFactory> unit_of_work_factory, std::vector<extra_data::MapExtraData> maps_extra_data, std::shared_ptr<Strand> strand, const fs::path & root)
-        : game_{game}, app_{application}, generator_{generator}, unit_of_work_factory_{unit_of_work_factory}, maps_extra_data_{maps_extra_data}, strand_{strand}, root_{root} {
+    RequestHandler(std::shared_ptr<model::Game> game, app::Application & application, loot_gen::LootGenerator& generator, std::shared_ptr<app::DbExecutor> db_executor, app::Leaderboard & leaderboard, journal::Journal & journal, std::vector<extra_data::MapExtraData> maps_extra_data, std::shared_ptr<Strand> strand, const fs::path & root, static_cache::StaticCache & static_cache, StatePublisher & state_publisher)
+        : game_{game}, app_{application}, generator_{generator}, db_executor_{db_executor}, leaderboard_{leaderboard}, journal_{journal}, strand_{strand}, root_{root}, static_cache_{static_cache}, state_publisher_{state_publisher}, maps_response_{BuildMapsResponse(*game)}, map_responses_{BuildMapResponses(*game, maps_extra_data)}, router_{BuildRouter()} {
     }
 
     RequestHandler(const RequestHandler&) = delete;
-    RequestHandler& operator=(const RequestHandler&) = delete;    
+    RequestHandler& operator=(const RequestHandler&) = delete;
 
     template <typename Body, typename Allocator, typename Send>
     void operator()(http::request<Body, Allocator> && request, Send&& send) {
-        std::chrono::time_point<std::chrono::system_clock> start_response_time = std::chrono::system_clock::now();
+        TimePoint start_response_time = std::chrono::system_clock::now();
 
-//  *   REQUEST TARGET DECODING AND MAKE ABSOLUTE PATH
-        std::string request_target_str{request.target().data(), request.target().size()};
-        request_target_str = http_utils::UrlDecode(request_target_str);
+//  *   REQUEST TARGET DECODING
+        std::string request_target_str = http_utils::UrlDecode(request.target());
         request.target(request_target_str);
 
-        fs::path request_target{request_target_str};
-        request_target = fs::weakly_canonical(request_target);
+//  *   API routes are matched on the lexically normalized path, only static files touch the filesystem
+        std::string_view route_path = http_utils::NormalizePath(request_target_str);
 
-//  *   CONSTRUCT DEFAULT RESPONSE
-        HttpResponse response = ConstructJsonResponse(http::status::not_found, request.version());
-        response.body() = json_builder::GetPageNotFound_s();
+        Router::Match match = router_.Find(route_path, request.method());
 
-        std::vector<endpoint::Endpoint<Body, Allocator>> endpoints;
+        if (match.status == Router::Status::FOUND) {
+            return Dispatch(match, std::move(request), send, start_response_time);
+        }
 
-//  *   Mapping:
-//  *   /api/v1/maps
-//  *   Methods: GET, HEAD
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/maps"}, http::verb::get, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructOkResponse(json_builder::GetMaps_s(self->game_->GetMaps()), req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }));
+        if (match.status == Router::Status::METHOD_NOT_ALLOWED) {
+            HttpResponse response = ConstructMethodNotAllowedResponse(match.allow, request.version(), request.keep_alive());
+            return send(std::move(response), start_response_time);
+        }
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/maps"}, http::verb::head, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructOkResponse(req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }));
+//  *   Local file access: {root}/...
+        if (request.method() == http::verb::get) {
+            return SendFile(route_path, std::move(request), send, start_response_time);
+        }
 
-//  *   Methods: POST, PUT, DELETE, PATCH, OPTIONS
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/maps"}, http::verb::post, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }));
+        HttpResponse response = ConstructJsonResponse(http::status::not_found, request.version(), request.keep_alive());
+        response.body() = json_builder::GetPageNotFound_s();
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/maps"}, http::verb::delete_, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }));
+        send(std::move(response), start_response_time);
+    }
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/maps"}, http::verb::options, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }));
+private:
+    enum class Route {
+        MAPS,
+        MAPS_HEAD,
+        MAP,
+        MAP_HEAD,
+        JOIN,
+        PLAYERS,
+        PLAYERS_HEAD,
+        STATE,
+        STATE_HEAD,
+        ACTION,
+        TICK,
+        RECORDS,
+        RECORDS_HEAD,
+        WEBSOCKET,
+        METRICS,
+        API_BAD_REQUEST
+    };
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/maps"}, http::verb::put, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }));
+    using Router = router::Router<Route>;
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/maps"}, http::verb::patch, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }));
-
-// *    Mapping:
-// *    /api/v1/maps/{map_id}/
-// *    Methods: GET, HEAD
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/maps"}, http::verb::get, [self = this, &send, request_target, start_response_time] (http::request<Body, Allocator> && req) {
-            std::string map_id{request_target.filename().string()};
-
-            const model::Map * map = self->game_->FindMap(model::Map::Id{map_id});
-
-            if (map) {
-                extra_data::MapExtraData * map_extra_data;
-                for (extra_data::MapExtraData & ed : self->maps_extra_data_) {
-                    if (ed.GetMapId() == *(map->GetId())) {
-                        map_extra_data = &ed;
-                        break;
-                    }
-                }
+//  *   Maps don't change after loading: their JSON is serialized once and every response shares it
+    using MapResponses = std::map<std::string, static_cache::AssetPtr, std::less<>>;
 
-                HttpResponse response = ConstructOkResponse(json_builder::GetMapWithExtraData_s(*map, *map_extra_data), req.version(), req.keep_alive());
-                send(std::move(response), start_response_time);
-            }
-            else { 
-                HttpResponse response = ConstructMapNotFoundResponse(req.version(), req.keep_alive());
-                send(std::move(response), start_response_time);
-            }
-        }, 1));
+    static static_cache::AssetPtr BuildMapsResponse(const model::Game & game);
+    static MapResponses BuildMapResponses(const model::Game & game, const std::vector<extra_data::MapExtraData> & maps_extra_data);
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/maps"}, http::verb::head, [self = this, request_target, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            std::string map_id{request_target.filename().string()};
+//  *   Uncompressed static bodies from this size are sent with sendfile
+    static constexpr size_t SENDFILE_MIN_SIZE = 64 * 1024;
 
-            const model::Map * map = self->game_->FindMap(model::Map::Id{map_id});
+//  *   Methods missing for a path are answered with 405 and the registered ones in "Allow"
+    static Router BuildRouter() {
+        Router router;
 
-            if (map) {
-                HttpResponse response = ConstructOkResponse(req.version(), req.keep_alive());
-                send(std::move(response), start_response_time);
-            }
-            else { 
-                HttpResponse response = ConstructMapNotFoundResponse(req.version(), req.keep_alive());
-                send(std::move(response), start_response_time);
-            }
-        }, 1));
+        router.Add("/api/v1/maps", http::verb::get, Route::MAPS);
+        router.Add("/api/v1/maps", http::verb::head, Route::MAPS_HEAD);
 
+        router.Add("/api/v1/maps/{map_id}", http::verb::get, Route::MAP);
+        router.Add("/api/v1/maps/{map_id}", http::verb::head, Route::MAP_HEAD);
 
-// *    Mapping:
-// *    /api/v1/maps/{map_id}
-// *    Methods: POST, PUT, DELETE, OPTIONS
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/maps"}, http::verb::post, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }, 1));
+        router.Add("/api/v1/game/join", http::verb::post, Route::JOIN);
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/maps"}, http::verb::delete_, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }, 1));
+        router.Add("/api/v1/game/players", http::verb::get, Route::PLAYERS);
+        router.Add("/api/v1/game/players", http::verb::head, Route::PLAYERS_HEAD);
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/maps"}, http::verb::options, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }, 1));
+        router.Add("/api/v1/game/state", http::verb::get, Route::STATE);
+        router.Add("/api/v1/game/state", http::verb::head, Route::STATE_HEAD);
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/maps"}, http::verb::put, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }, 1));
+        router.Add("/api/v1/game/player/action", http::verb::post, Route::ACTION);
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/maps"}, http::verb::patch, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }, 1));
+        router.Add("/api/v1/game/tick", http::verb::post, Route::TICK);
 
-// *    Join, METHOD: POST
-// *    Mapping:
-// *    /api/v1/game/join
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/join"}, http::verb::post, [self = this, &send, start_response_time, strand_ptr = std::shared_ptr<Strand>(strand_)] (http::request<Body, Allocator> && req) {
-            sys::error_code ec;
-            std::string connection_data{req.body().data(), req.body().size()};
-            json::value request_body_val = json::parse(connection_data, ec);
+        router.Add("/api/v1/game/ws", http::verb::get, Route::WEBSOCKET);
 
-            try {
-                if (req.at(http::field::content_type) != http_content_type::JSON) {
-                    throw "Content-Type is invalid";
-                }
-            } catch (...) {
-                HttpResponse response = ConstructBadRequestResponse("Content-Type is invalid"sv, req.version(), req.keep_alive());
-                return send(std::move(response), start_response_time);
-            }
+        router.Add("/api/v1/game/records", http::verb::get, Route::RECORDS);
+        router.Add("/api/v1/game/records", http::verb::head, Route::RECORDS_HEAD);
 
-            if (ec) {
-                std::string error_data{ec.message().data(), ec.message().size()};
-                HttpResponse response = ConstructInvalidArgumentResponse(error_data, req.version(), req.keep_alive());
-                return send(response, start_response_time);
-            }
+        router.Add("/api/v1/metrics", http::verb::get, Route::METRICS);
 
-            if (!request_body_val.as_object().contains( json_fields::AUTENTICATE_PLAYER_NAME )) {
-                HttpResponse response = ConstructInvalidArgumentResponse("JSON parse error: Couldn't find \"userName\" field"sv, req.version(), req.keep_alive());
-                return send(std::move(response), start_response_time);
-            }
+//  *   Any other GET under /api/
+        router.Add("/api/*", http::verb::get, Route::API_BAD_REQUEST);
 
-            if (!request_body_val.as_object().contains( json_fields::AUTENTICATE_MAP_ID )) {
-                HttpResponse response = ConstructInvalidArgumentResponse("JSON parse error: Couldn't find \"mapId\" field"sv, req.version(), req.keep_alive());
-                return send(std::move(response), start_response_time);
-            }
+        return router;
+    }
 
-            std::string player_name{request_body_val.at( json_fields::AUTENTICATE_PLAYER_NAME ).as_string()};
-            std::string map_id{request_body_val.at( json_fields::AUTENTICATE_MAP_ID ).as_string()};
+    template <typename Body, typename Allocator, typename Send>
+    void Dispatch(const Router::Match & match, http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        switch (match.route) {
+            case Route::MAPS:
+                return GetMaps(std::move(req), send, start_response_time);
+            case Route::MAPS_HEAD:
+                return send(ConstructOkResponse(req.version(), req.keep_alive()), start_response_time);
+            case Route::MAP:
+                return GetMap(match.params[0], std::move(req), send, start_response_time);
+            case Route::MAP_HEAD:
+                return HeadMap(match.params[0], std::move(req), send, start_response_time);
+            case Route::JOIN:
+                return Join(std::move(req), send, start_response_time);
+            case Route::PLAYERS:
+                return GetPlayers(std::move(req), send, start_response_time);
+            case Route::PLAYERS_HEAD:
+                return HeadPlayers(std::move(req), send, start_response_time);
+            case Route::STATE:
+                return GetState(std::move(req), send, start_response_time);
+            case Route::STATE_HEAD:
+                return HeadState(std::move(req), send, start_response_time);
+            case Route::ACTION:
+                return Action(std::move(req), send, start_response_time);
+            case Route::TICK:
+                return Tick(std::move(req), send, start_response_time);
+            case Route::RECORDS:
+                return GetRecords(std::move(req), send, start_response_time);
+            case Route::RECORDS_HEAD:
+                return HeadRecords(std::move(req), send, start_response_time);
+            case Route::WEBSOCKET:
+                return OpenWebSocket(std::move(req), send, start_response_time);
+            case Route::METRICS:
+                return send(ConstructMetricsResponse(req.version(), req.keep_alive()), start_response_time);
+            case Route::API_BAD_REQUEST:
+                return send(ConstructBadRequestResponse(json_builder::GetBadRequest_s(), req.version(), req.keep_alive()), start_response_time);
+        }
+    }
 
-            if (player_name.size() == 0) {
-                HttpResponse response = ConstructInvalidArgumentResponse("Invalid value: player name can't be empty"sv, req.version(), req.keep_alive());
-                return send(std::move(response), start_response_time);
-            }
+// *    GET /api/v1/maps
+    template <typename Body, typename Allocator, typename Send>
+    void GetMaps(http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        send(ConstructAssetResponse(maps_response_, req, req.version(), req.keep_alive()), start_response_time);
+    }
 
-            const model::Map * map = self->game_->FindMap(model::Map::Id{map_id});
-            if (map == nullptr) {
-                HttpResponse response = ConstructMapNotFoundResponse(req.version(), req.keep_alive());
-                return send(std::move(response), start_response_time);
-            }
+// *    GET /api/v1/maps/{map_id}
+    template <typename Body, typename Allocator, typename Send>
+    void GetMap(std::string_view map_id, http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        auto it = map_responses_.find(map_id);
+
+        if (it != map_responses_.end()) {
+            send(ConstructAssetResponse(it->second, req, req.version(), req.keep_alive()), start_response_time);
+        }
+        else {
+            HttpResponse response = ConstructMapNotFoundResponse(req.version(), req.keep_alive());
+            send(std::move(response), start_response_time);
+        }
+    }
+
+// *    HEAD /api/v1/maps/{map_id}
+    template <typename Body, typename Allocator, typename Send>
+    void HeadMap(std::string_view map_id, http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        if (map_responses_.find(map_id) != map_responses_.end()) {
+            HttpResponse response = ConstructOkResponse(req.version(), req.keep_alive());
+            send(std::move(response), start_response_time);
+        }
+        else {
+            HttpResponse response = ConstructMapNotFoundResponse(req.version(), req.keep_alive());
+            send(std::move(response), start_response_time);
+        }
+    }
 
-            net::dispatch(*strand_ptr, [self, send, start_response_time, req, strand_ptr, player_name, map] {
-                model::GameSession * session = self->game_->NewSession(const_cast<model::Map *>(map));
+// *    POST /api/v1/game/join
+    template <typename Body, typename Allocator, typename Send>
+    void Join(http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        sys::error_code ec;
+        std::string connection_data{req.body().data(), req.body().size()};
+        json::value request_body_val = json::parse(connection_data, ec);
+
+        try {
+            if (req.at(http::field::content_type) != http_content_type::JSON) {
+                throw "Content-Type is invalid";
+            }
+        } catch (...) {
+            HttpResponse response = ConstructBadRequestResponse("Content-Type is invalid"sv, req.version(), req.keep_alive());
+            return send(std::move(response), start_response_time);
+        }
 
-                app::Player player = app::PlayersManager::Instance().AddNewPlayer(player_name, session);
+        if (ec) {
+            std::string error_data{ec.message().data(), ec.message().size()};
+            HttpResponse response = ConstructInvalidArgumentResponse(error_data, req.version(), req.keep_alive());
+            return send(response, start_response_time);
+        }
 
-                HttpResponse response = ConstructOkResponse(json_builder::GetTokenAndPlayerId_s(player.GetToken(), player.GetPlayerId()), req.version(), req.keep_alive());
+        if (!request_body_val.as_object().contains( json_fields::AUTENTICATE_PLAYER_NAME )) {
+            HttpResponse response = ConstructInvalidArgumentResponse("JSON parse error: Couldn't find \"userName\" field"sv, req.version(), req.keep_alive());
+            return send(std::move(response), start_response_time);
+        }
 
-                return send(std::move(response), start_response_time);
-            });
-        }));
+        if (!request_body_val.as_object().contains( json_fields::AUTENTICATE_MAP_ID )) {
+            HttpResponse response = ConstructInvalidArgumentResponse("JSON parse error: Couldn't find \"mapId\" field"sv, req.version(), req.keep_alive());
+            return send(std::move(response), start_response_time);
+        }
 
-// *    Join, METHOD: GET, PUT, DELETE, HEAD
-// *    /api/v1/game/join
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/join"}, http::verb::get, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+        std::string player_name{request_body_val.at( json_fields::AUTENTICATE_PLAYER_NAME ).as_string()};
+        std::string map_id{request_body_val.at( json_fields::AUTENTICATE_MAP_ID ).as_string()};
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/join"}, http::verb::put, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+        if (player_name.size() == 0) {
+            HttpResponse response = ConstructInvalidArgumentResponse("Invalid value: player name can't be empty"sv, req.version(), req.keep_alive());
+            return send(std::move(response), start_response_time);
+        }
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/join"}, http::verb::delete_, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+        const model::Map * map = game_->FindMap(model::Map::Id{map_id});
+        if (map == nullptr) {
+            HttpResponse response = ConstructMapNotFoundResponse(req.version(), req.keep_alive());
+            return send(std::move(response), start_response_time);
+        }
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/join"}, http::verb::head, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+        net::dispatch(*strand_, [self = this, send, start_response_time, req = std::move(req), player_name, map] {
+            model::GameSession * session = self->game_->NewSession(const_cast<model::Map *>(map));
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/join"}, http::verb::options, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+            std::shared_ptr<app::Player> player = app::PlayersManager::Instance().AddNewPlayer(player_name, session, self->app_.GetGameTime());
+            self->app_.OnDogStopped(player->GetPlayerId());
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/join"}, http::verb::patch, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+            model::Vector2 position = session->GetDogById(player->GetPlayerId())->GetPosition();
+            self->journal_.Append(journal::JoinRecord{player->GetPlayerId(), app::ParseToken(player->GetToken()), player_name, *map->GetId(),
+                position.x, position.y, player->GetJoinTime().count()});
 
+            HttpResponse response = ConstructOkResponse(json_builder::GetTokenAndPlayerId_s(player->GetToken(), player->GetPlayerId()), req.version(), req.keep_alive());
 
-// *    Mapping:
-// *    /api/v1/game/players
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/players"}, http::verb::get, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            try {
-                std::string token{http_utils::FormatToken(req.at(http::field::authorization))};
+            return send(std::move(response), start_response_time);
+        });
+    }
 
-                app::Player * player = app::PlayersManager::Instance().GetPlayerByToken(token);
+// *    GET /api/v1/game/players
+    template <typename Body, typename Allocator, typename Send>
+    void GetPlayers(http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        try {
+            std::string token{http_utils::FormatToken(req.at(http::field::authorization))};
 
-                if (player == nullptr) {
-                    HttpResponse response{ConstructUnauthorizedResponse(json_builder::GetUnknownToken_s(), req.version(), req.keep_alive())};
-                    return send(std::move(response), start_response_time);
-                }
+            std::shared_ptr<app::Player> player = app::PlayersManager::Instance().GetPlayerByToken(token);
 
-                HttpResponse response{ConstructOkResponse(json_builder::GetPlayers_s(self->game_->GetSessionById(player->GetSessionId())), req.version(), req.keep_alive())};
-                return send(std::move(response), start_response_time);
-            } catch (std::exception & ex) {
-                HttpResponse response{ConstructUnauthorizedResponse(json_builder::GetInvalidToken_s(), req.version(), req.keep_alive())};
+            if (player == nullptr) {
+                HttpResponse response{ConstructUnauthorizedResponse(json_builder::GetUnknownToken_s(), req.version(), req.keep_alive())};
                 return send(std::move(response), start_response_time);
             }
-        }));
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/players"}, http::verb::head, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            try {
-                std::string token{http_utils::FormatToken(req.at(http::field::authorization))};
+            HttpResponse response{ConstructOkResponse(json_builder::GetPlayers_s(game_->GetSessionById(player->GetSessionId())), req.version(), req.keep_alive())};
+            return send(std::move(response), start_response_time);
+        } catch (std::exception & ex) {
+            HttpResponse response{ConstructUnauthorizedResponse(json_builder::GetInvalidToken_s(), req.version(), req.keep_alive())};
+            return send(std::move(response), start_response_time);
+        }
+    }
 
-                app::Player * player = app::PlayersManager::Instance().GetPlayerByToken(token);
+// *    HEAD /api/v1/game/players
+    template <typename Body, typename Allocator, typename Send>
+    void HeadPlayers(http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        try {
+            std::string token{http_utils::FormatToken(req.at(http::field::authorization))};
 
-                if (player == nullptr) {
-                    HttpResponse response{ConstructUnauthorizedResponse(req.version(), req.keep_alive())};
-                    return send(std::move(response), start_response_time);
-                }
+            std::shared_ptr<app::Player> player = app::PlayersManager::Instance().GetPlayerByToken(token);
 
-                HttpResponse response{ConstructOkResponse(req.version(), req.keep_alive())};
-                return send(std::move(response), start_response_time);
-            } catch (std::exception & ex) {
+            if (player == nullptr) {
                 HttpResponse response{ConstructUnauthorizedResponse(req.version(), req.keep_alive())};
                 return send(std::move(response), start_response_time);
             }
-        }));
-
-// *    POST, PUT, OPTIONS, DELETE, PATCH
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/players"}, http::verb::post, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("GET, HEAD"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/players"}, http::verb::put, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("GET, HEAD"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+            HttpResponse response{ConstructOkResponse(req.version(), req.keep_alive())};
+            return send(std::move(response), start_response_time);
+        } catch (std::exception & ex) {
+            HttpResponse response{ConstructUnauthorizedResponse(req.version(), req.keep_alive())};
+            return send(std::move(response), start_response_time);
+        }
+    }
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/players"}, http::verb::delete_, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("GET, HEAD"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+// *    GET /api/v1/game/state
+    template <typename Body, typename Allocator, typename Send>
+    void GetState(http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        try {
+            std::string token{http_utils::FormatToken(req.at(http::field::authorization))};
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/players"}, http::verb::options, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("GET, HEAD"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+            std::shared_ptr<app::Player> player = app::PlayersManager::Instance().GetPlayerByToken(token);
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/players"}, http::verb::patch, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("GET, HEAD"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+            if (player == nullptr) {
+                HttpResponse response{ConstructUnauthorizedResponse(json_builder::GetUnknownToken_s(), req.version(), req.keep_alive())};
+                return send(std::move(response), start_response_time);
+            }
 
-// *    Mapping:
-// *    /api/v1/game/state
-// *    Methods: GET, HEAD
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/state"}, http::verb::get, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            try {
-                std::string token{http_utils::FormatToken(req.at(http::field::authorization))};
+            HttpResponse response{ConstructOkResponse(json_builder::GetPlayersInfo_s(game_->GetSessionById(player->GetSessionId())), req.version(), req.keep_alive())};
+            return send(std::move(response), start_response_time);
+        } catch (std::exception & ex) {
+            HttpResponse response{ConstructUnauthorizedResponse(json_builder::GetInvalidToken_s(), req.version(), req.keep_alive())};
+            return send(std::move(response), start_response_time);
+        }
+    }
 
-                app::Player * player = app::PlayersManager::Instance().GetPlayerByToken(token);
+// *    HEAD /api/v1/game/state
+    template <typename Body, typename Allocator, typename Send>
+    void HeadState(http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        try {
+            std::string token{http_utils::FormatToken(req.at(http::field::authorization))};
 
-                if (player == nullptr) {
-                    HttpResponse response{ConstructUnauthorizedResponse(json_builder::GetUnknownToken_s(), req.version(), req.keep_alive())};
-                    return send(std::move(response), start_response_time);
-                }
+            std::shared_ptr<app::Player> player = app::PlayersManager::Instance().GetPlayerByToken(token);
 
-                HttpResponse response{ConstructOkResponse(json_builder::GetPlayersInfo_s(self->game_->GetSessionById(player->GetSessionId())), req.version(), req.keep_alive())};
-                return send(std::move(response), start_response_time);
-            } catch (std::exception & ex) {
-                HttpResponse response{ConstructUnauthorizedResponse(json_builder::GetInvalidToken_s(), req.version(), req.keep_alive())};
+            if (player == nullptr) {
+                HttpResponse response{ConstructUnauthorizedResponse(json_builder::GetUnknownToken_s(), req.version(), req.keep_alive())};
                 return send(std::move(response), start_response_time);
             }
-        }));
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/state"}, http::verb::head, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            try {
-                std::string token{http_utils::FormatToken(req.at(http::field::authorization))};
+            HttpResponse response{ConstructOkResponse(req.version(), req.keep_alive())};
+            return send(std::move(response), start_response_time);
+        } catch (std::exception & ex) {
+            HttpResponse response{ConstructUnauthorizedResponse(json_builder::GetInvalidToken_s(), req.version(), req.keep_alive())};
+            return send(std::move(response), start_response_time);
+        }
+    }
+
+// *    POST /api/v1/game/player/action
+    template <typename Body, typename Allocator, typename Send>
+    void Action(http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        try {
+            if (req.at(http::field::content_type) != http_content_type::JSON) {
+                throw std::logic_error("Content-Type is invalid");
+            }
+        } catch (std::exception & ex) {
+            HttpResponse response = ConstructBadRequestResponse(ex.what(), req.version(), req.keep_alive());
+            return send(std::move(response), start_response_time);
+        }
 
-                app::Player * player = app::PlayersManager::Instance().GetPlayerByToken(token);
+        std::shared_ptr<app::Player> player;
+        std::string token;
+        try {
+            token = std::string{req.at(http::field::authorization).data(), req.at(http::field::authorization).size()};
+            token = {http_utils::FormatToken(token)};
 
-                if (player == nullptr) {
-                    HttpResponse response{ConstructUnauthorizedResponse(json_builder::GetUnknownToken_s(), req.version(), req.keep_alive())};
-                    return send(std::move(response), start_response_time);
-                }
+            player = app::PlayersManager::Instance().GetPlayerByToken(token);
 
-                HttpResponse response{ConstructOkResponse(req.version(), req.keep_alive())};
-                return send(std::move(response), start_response_time);
-            } catch (std::exception & ex) {
-                HttpResponse response{ConstructUnauthorizedResponse(json_builder::GetInvalidToken_s(), req.version(), req.keep_alive())};
+            if (player == nullptr) {
+                HttpResponse response = ConstructUnauthorizedResponse("Player token has not been found"sv, req.version(), req.keep_alive());
                 return send(std::move(response), start_response_time);
             }
-        }));
+        } catch (std::exception & ex) {
+            HttpResponse response = ConstructUnauthorizedResponse(ex.what(), req.version(), req.keep_alive());
+            return send(std::move(response), start_response_time);
+        }
 
-// *    OPTIONS, POST, PUT, PATCH, DELETE
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/state"}, http::verb::post, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }));
+        json::value val = json::parse(req.body());
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/state"}, http::verb::put, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }));
+        if (!val.as_object().contains("move")) {
+            HttpResponse response = ConstructBadRequestResponse("Incorrect Json: can't find field \"move\""sv, req.version(), req.keep_alive());
+            return send(std::move(response), start_response_time);
+        }
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/state"}, http::verb::delete_, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }));
+        std::optional<model::Direction> move = ParseMove(val.at("move").as_string());
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/state"}, http::verb::options, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }));
+        if (!move) {
+            HttpResponse response = ConstructBadRequestResponse("Incorrect Json: invalid value in field \"move\""sv, req.version(), req.keep_alive());
+            return send(std::move(response), start_response_time);
+        }
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/state"}, http::verb::patch, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructMethodNotAllowedResponse("GET, HEAD", req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }));
-
-// *    Mapping:
-// *    /api/v1/game/player/action
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/player/action"}, http::verb::post, [self = this, send, start_response_time, strand_ptr = std::shared_ptr<Strand>(strand_)] (http::request<Body, Allocator> && req) {
-                try {
-                    if (req.at(http::field::content_type) != http_content_type::JSON) {
-                        throw std::logic_error("Content-Type is invalid");
-                    }
-                } catch (std::exception & ex) {
-                    HttpResponse response = ConstructBadRequestResponse(ex.what(), req.version(), req.keep_alive());
-                    return send(std::move(response), start_response_time);
-                }
-                
-                app::Player * player = 0;
-                std::string token;
-                try {
-                    token = std::string{req.at(http::field::authorization).data(), req.at(http::field::authorization).size()};
-                    token = {http_utils::FormatToken(token)};
-
-                    player = app::PlayersManager::Instance().GetPlayerByToken(token);
-
-                    if (player == nullptr) {
-                        HttpResponse response = ConstructUnauthorizedResponse("Player token has not been found"sv, req.version(), req.keep_alive());
-                        return send(std::move(response), start_response_time);
-                    }
-                } catch (std::exception & ex) {
-                    HttpResponse response = ConstructUnauthorizedResponse(ex.what(), req.version(), req.keep_alive());
-                    return send(std::move(response), start_response_time);
-                }
+        model::Direction dir = *move;
 
-                json::value val = json::parse(req.body());
+        net::dispatch(*strand_, [self = this, dir, token] {
+            std::shared_ptr<app::Player> player = app::PlayersManager::Instance().GetPlayerByToken(token);
+            if (!player) {
+                return;
+            }
 
-                if (!val.as_object().contains("move")) {
-                    HttpResponse response = ConstructBadRequestResponse("Incorrect Json: can't find field \"move\""sv, req.version(), req.keep_alive());
-                    return send(std::move(response), start_response_time);
-                }
+            model::GameSession * session = self->game_->GetSessionById(player->GetSessionId());
+            model::Dog * dog = session->GetDogById(player->GetPlayerId());
 
-                model::Direction dir = model::Direction::ZERO;
-
-                if (val.at("move").as_string() == "L") {
-                    dir = model::Direction::WEST;
-                } else if (val.at("move").as_string() == "R") {
-                    dir = model::Direction::EAST;
-                } else if (val.at("move").as_string() == "U") {
-                    dir = model::Direction::NORTH;
-                } else if (val.at("move").as_string() == "D") {
-                    dir = model::Direction::SOUTH;
-                } else if (val.at("move").as_string() == "") {
-                    dir = model::Direction::ZERO;
-                } else {
-                    HttpResponse response = ConstructBadRequestResponse("Incorrect Json: invalid value in field \"move\""sv, req.version(), req.keep_alive());
-                    return send(std::move(response), start_response_time);
-                }
+            self->journal_.Append(journal::MoveRecord{player->GetPlayerId(), dir});
+            self->app_.MoveDog(*session, *dog, dir);
+        });
 
-                net::dispatch(*strand_ptr, [self, /*game_ptr, */start_response_time, dir, /*player,*/ strand_ptr, token] {
-                    app::Player * player = app::PlayersManager::Instance().GetPlayerByToken(token);
-                    model::GameSession * session = self->game_->GetSessionById(player->GetSessionId());
-                    model::Dog * dog = session->GetDogById(player->GetPlayerId());
-
-                    if (dir == model::Direction::NORTH) {
-                        dog->SetSpeed(model::Vector2{0, -session->GetMap()->GetDogSpeed()});
-                    } else if (dir == model::Direction::EAST) {
-                        dog->SetSpeed(model::Vector2{session->GetMap()->GetDogSpeed(), 0});
-                    } else if (dir == model::Direction::SOUTH) {
-                        dog->SetSpeed(model::Vector2{0, session->GetMap()->GetDogSpeed()});
-                    } else if (dir == model::Direction::WEST) {
-                        dog->SetSpeed(model::Vector2{-session->GetMap()->GetDogSpeed(), 0});
-                    } else {
-                        dog->SetSpeed(model::Vector2{0, 0});
-                    }
-
-                    if (dir != model::Direction::ZERO) {
-                        dog->SetDirection(dir);
-                    }
-                });
-
-                HttpResponse response = ConstructOkResponse("{}"sv, req.version(), req.keep_alive());
-                return send(std::move(response), start_response_time);
-        }));
+        HttpResponse response = ConstructOkResponse("{}"sv, req.version(), req.keep_alive());
+        return send(std::move(response), start_response_time);
+    }
 
-// *    GET, HEAD, PUT, DELETE, OPTIONS, PATCH
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/player/action"}, http::verb::get, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+// *    GET /api/v1/game/ws
+//  *   The token is checked once: as "?token=" (browsers can't set headers on a WebSocket) or in Authorization.
+//  *   The socket then gets the session state after every tick and takes {"move": ...} messages
+    template <typename Body, typename Allocator, typename Send>
+    void OpenWebSocket(http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        if (!beast::websocket::is_upgrade(req)) {
+            HttpResponse response{ConstructBadRequestResponse("WebSocket upgrade is expected"sv, req.version(), req.keep_alive())};
+            return send(std::move(response), start_response_time);
+        }
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/player/action"}, http::verb::head, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+        std::string token;
+        try {
+            std::optional<std::string_view> query_token = http_utils::GetQueryParam(req.target(), "token"sv);
+            token = query_token ? std::string{*query_token} : http_utils::FormatToken(req.at(http::field::authorization));
+        } catch (std::exception & ex) {
+            HttpResponse response{ConstructUnauthorizedResponse(json_builder::GetInvalidToken_s(), req.version(), false)};
+            return send(std::move(response), start_response_time);
+        }
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/player/action"}, http::verb::put, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+        std::shared_ptr<app::Player> player = app::PlayersManager::Instance().GetPlayerByToken(token);
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/player/action"}, http::verb::options, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+        if (player == nullptr) {
+            HttpResponse response{ConstructUnauthorizedResponse(json_builder::GetUnknownToken_s(), req.version(), false)};
+            return send(std::move(response), start_response_time);
+        }
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/player/action"}, http::verb::patch, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+        int player_id = player->GetPlayerId();
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/player/action"}, http::verb::delete_, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+        send(http_server::WebSocketUpgrade{std::move(req), [self = this, player_id] (beast::tcp_stream && stream, http_server::HttpRequest && request) {
+            auto socket = std::make_shared<http_server::WebSocketSession>(std::move(stream));
 
-// *    Mapping:
-// *    /api/v1/game/tick
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/tick"}, http::verb::post, [self = this, &send, start_response_time, strand_ptr = std::shared_ptr<Strand>(strand_)] (http::request<Body, Allocator> && req) {
-            if (!self->game_->IsTimerStopped()) {
-                HttpResponse response{ConstructBadRequestResponse(json_builder::GetBadRequest_s(), req.version(), req.keep_alive())};
-                return send(std::move(response), start_response_time);
-            }
+            socket->Run(std::move(request), [self, player_id] (std::string_view message) {
+                self->OnSocketMessage(player_id, message);
+            });
 
-            try {
-                if (req.at(http::field::content_type) != http_content_type::JSON) {
-                    throw "Content-Type is invalid";
+            net::dispatch(*self->strand_, [self, player_id, socket] {
+                if (!self->state_publisher_.Subscribe(player_id, socket)) {
+                    socket->Close();
                 }
-            } catch (std::exception & ex) {
-                HttpResponse response{ConstructBadRequestResponse(ex.what(), req.version(), req.keep_alive())};
-                return send(std::move(response), start_response_time);
-            }
-            
-            sys::error_code ec;
+            });
+        }}, start_response_time);
+    }
 
-            json::value val = json::parse(req.body(), ec);
+//  *   Malformed messages are ignored, the socket stays open
+    void OnSocketMessage(int player_id, std::string_view message) {
+        std::optional<model::Direction> move = ParseMoveMessage(message);
+        if (!move) {
+            return;
+        }
 
-            if (ec) {
-                HttpResponse response{ConstructBadRequestResponse("Json parse error"sv, req.version(), req.keep_alive())};
-                return send(std::move(response), start_response_time);
-            }
+        net::dispatch(*strand_, [self = this, player_id, dir = *move] {
+            std::shared_ptr<app::Player> player = app::PlayersManager::Instance().GetPlayerById(player_id);
+            model::GameSession * session = player ? self->game_->GetSessionById(player->GetSessionId()) : nullptr;
+            model::Dog * dog = session ? session->GetDogById(player_id) : nullptr;
 
-            if (!val.as_object().contains("timeDelta")) {
-                HttpResponse response{ConstructBadRequestResponse("No field \"timeDelta\""sv, req.version(), req.keep_alive())};
-                return send(std::move(response), start_response_time);
+            if (!dog) {
+                return;
             }
 
-            int time_delta = 0;
-            try {
-                time_delta = val.at("timeDelta").as_int64();
-            } catch (std::exception & ex) {
-                HttpResponse response{ConstructBadRequestResponse("Invalid type of field \"timeDelta\""sv, req.version(), req.keep_alive())};
-                return send(std::move(response), start_response_time);
+            self->journal_.Append(journal::MoveRecord{player_id, dir});
+            self->app_.MoveDog(*session, *dog, dir);
+        });
+    }
+
+// *    POST /api/v1/game/tick
+    template <typename Body, typename Allocator, typename Send>
+    void Tick(http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        if (!game_->IsTimerStopped()) {
+            HttpResponse response{ConstructBadRequestResponse(json_builder::GetBadRequest_s(), req.version(), req.keep_alive())};
+            return send(std::move(response), start_response_time);
+        }
+
+        try {
+            if (req.at(http::field::content_type) != http_content_type::JSON) {
+                throw "Content-Type is invalid";
             }
+        } catch (std::exception & ex) {
+            HttpResponse response{ConstructBadRequestResponse(ex.what(), req.version(), req.keep_alive())};
+            return send(std::move(response), start_response_time);
+        }
 
-            net::dispatch(*strand_ptr, [self, time_delta, strand_ptr] {                
-                self->app_.Tick(std::chrono::milliseconds(time_delta));
-                self->game_->Tick(time_delta, [self, time_delta] {
-                    for (model::GameSession & session : self->game_->GetSessions()) {
-                        session.AddItems(self->generator_.Generate(std::chrono::milliseconds(time_delta), session.GetItems().size(), session.GetDogs().size()));
-                        collision_detector::UpdateSessionItems(session, time_delta);
-                    }
-                });
-            });
+        sys::error_code ec;
 
-            HttpResponse response{ConstructOkResponse("{}", req.version(), req.keep_alive())};
-            response.set(http::field::content_type, "application/json");
-            response.keep_alive(req.keep_alive());
-            response.prepare_payload();
+        json::value val = json::parse(req.body(), ec);
 
+        if (ec) {
+            HttpResponse response{ConstructBadRequestResponse("Json parse error"sv, req.version(), req.keep_alive())};
             return send(std::move(response), start_response_time);
-        }));
+        }
 
-// *    GET, HEAD, PUT, DELETE, OPTIONS, PATCH
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/tick"}, http::verb::get, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+        if (!val.as_object().contains("timeDelta")) {
+            HttpResponse response{ConstructBadRequestResponse("No field \"timeDelta\""sv, req.version(), req.keep_alive())};
+            return send(std::move(response), start_response_time);
+        }
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/tick"}, http::verb::head, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+        std::int64_t time_delta_value = 0;
+        try {
+            time_delta_value = val.at("timeDelta").as_int64();
+        } catch (std::exception & ex) {
+            HttpResponse response{ConstructBadRequestResponse("Invalid type of field \"timeDelta\""sv, req.version(), req.keep_alive())};
+            return send(std::move(response), start_response_time);
+        }
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/tick"}, http::verb::put, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+//  *   The game clock never goes back and a delta must fit the int the game ticks with
+        if (time_delta_value < 0 || time_delta_value > std::numeric_limits<int>::max()) {
+            HttpResponse response{ConstructBadRequestResponse("Invalid value of field \"timeDelta\""sv, req.version(), req.keep_alive())};
+            return send(std::move(response), start_response_time);
+        }
+        int time_delta = static_cast<int>(time_delta_value);
+
+        net::dispatch(*strand_, [self = this, time_delta] {
+            std::uint32_t seed = RandomGenerator::NewSeed();
+            self->journal_.Append(journal::TickRecord{time_delta, seed});
+            RandomGenerator::Seed(seed);
+
+            self->app_.Tick(std::chrono::milliseconds(time_delta));
+            self->game_->Tick(time_delta, [self, time_delta] {
+                for (model::GameSession & session : self->game_->GetSessions()) {
+                    session.AddItems(self->generator_.Generate(std::chrono::milliseconds(time_delta), session.GetItems().size(), session.GetDogs().size()));
+                    collision_detector::UpdateSessionItems(session, time_delta);
+                }
+            });
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/tick"}, http::verb::delete_, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+            self->state_publisher_.Publish(*self->game_);
+        });
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/tick"}, http::verb::options, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+        HttpResponse response{ConstructOkResponse("{}", req.version(), req.keep_alive())};
+        response.set(http::field::content_type, "application/json");
+        response.keep_alive(req.keep_alive());
+        response.prepare_payload();
 
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/tick"}, http::verb::patch, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("POST"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+        return send(std::move(response), start_response_time);
+    }
 
-// *    Mapping: GET, head
-// *    /api/v1/game/records
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/records"}, http::verb::get, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            unsigned int offset = 0;
-            unsigned int limit = 100;
+// *    GET /api/v1/game/records
+    template <typename Body, typename Allocator, typename Send>
+    void GetRecords(http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        unsigned int offset = 0;
+        unsigned int limit = 100;
+        std::optional<std::string> cursor_token;
 
-            std::string url{req.target().data(), req.target().size()};
+        std::string url{req.target().data(), req.target().size()};
 
-            std::vector<std::string> url_components;
+        std::vector<std::string> url_components;
 
-            if (boost::split(url_components, url, boost::is_any_of("?")); url_components.size() == 2) {
-                std::string params{url_components.at(1)};
+        if (boost::split(url_components, url, boost::is_any_of("?")); url_components.size() == 2) {
+            std::string params{url_components.at(1)};
 
-                std::vector<std::string> params_splitted;
-                boost::split(params_splitted, params, boost::is_any_of("&"));
+            std::vector<std::string> params_splitted;
+            boost::split(params_splitted, params, boost::is_any_of("&"));
 
-                for (std::string & param : params_splitted) {
-                    std::vector<std::string> param_key_val;
+            for (std::string & param : params_splitted) {
+                std::vector<std::string> param_key_val;
 
-                    boost::split(param_key_val, param, boost::is_any_of("="));
+                boost::split(param_key_val, param, boost::is_any_of("="));
 
-                    if (param_key_val.at(0) == "start") {
-                        offset = std::stoi(param_key_val.at(1));
-                    } else if (param_key_val.at(0) == "maxItems") {
-                        limit = std::stoi(param_key_val.at(1));
-                    }
+                if (param_key_val.at(0) == "start") {
+                    offset = std::stoi(param_key_val.at(1));
+                } else if (param_key_val.at(0) == "maxItems") {
+                    limit = std::stoi(param_key_val.at(1));
+                } else if (param_key_val.at(0) == "cursor") {
+                    cursor_token = param_key_val.size() > 1 ? param_key_val.at(1) : std::string{};
                 }
             }
+        }
+
+        if (limit > 100) {
+            HttpResponse response{ConstructBadRequestResponse("Start top results must be less than 100"sv, req.version(), req.keep_alive())};
+            send(std::move(response), start_response_time);
+            return;
+        }
+
+// *    Cursor mode: "cursor=" (empty) starts from the top, every full page returns X-Next-Cursor
+        std::optional<app::ResultsCursor> cursor;
 
-            if (limit > 100) {
-                HttpResponse response{ConstructBadRequestResponse("Start top results must be less than 100"sv, req.version(), req.keep_alive())};
+        if (cursor_token && !cursor_token->empty()) {
+            try {
+                cursor = app::ParseResultsCursor(*cursor_token);
+            } catch (const std::invalid_argument &) {
+                HttpResponse response{ConstructBadRequestResponse("Invalid cursor"sv, req.version(), req.keep_alive())};
                 send(std::move(response), start_response_time);
+                return;
             }
+        }
 
-            auto unit_of_work = self->unit_of_work_factory_->NewUnitOfWork();
-            std::vector<app::GameResult> game_results = unit_of_work->Results()->GetResults(limit, offset);
-            unit_of_work->Commit();
+// *    Pages within the in-memory leaderboard never reach the database
+        if (cursor_token) {
+            std::optional<std::vector<app::GameResult>> game_results = cursor ? leaderboard_.GetPageAfter(*cursor, limit) : leaderboard_.GetPage(0, limit);
 
-            HttpResponse response{ConstructOkResponse(json_builder::GetTopGameResults_s(game_results), req.version(), req.keep_alive())};
+            if (game_results) {
+                send(ConstructRecordsResponse(*game_results, limit, true, req.version(), req.keep_alive()), start_response_time);
+                return;
+            }
+        } else if (std::optional<std::string> body = leaderboard_.GetPageJson(offset, limit)) {
+            HttpResponse response{ConstructOkResponse(*body, req.version(), req.keep_alive())};
             response.set(http::field::content_type, "application/json");
             response.prepare_payload();
 
             send(std::move(response), start_response_time);
-        }, true));
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/records"}, http::verb::head, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            unsigned int offset = 0;
-            unsigned int limit = 100;
+            return;
+        }
+
+// *    The rest is read on the DB executor, the IO thread is free while the query runs.
+// *    The coroutine resumes on the connection strand, the game thread never builds the response.
+        net::co_spawn(net::get_associated_executor(send),
+            SendRecordsFromDatabase(std::move(cursor), cursor_token.has_value(), offset, limit, req.version(), req.keep_alive(), send, start_response_time),
+            net::detached);
+    }
+
+// *    HEAD /api/v1/game/records
+    template <typename Body, typename Allocator, typename Send>
+    void HeadRecords(http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        unsigned int offset = 0;
+        unsigned int limit = 100;
 
-            std::string url{req.target().data(), req.target().size()};
+        std::string url{req.target().data(), req.target().size()};
 
-            std::vector<std::string> url_components;
+        std::vector<std::string> url_components;
 
-            if (boost::split(url_components, url, boost::is_any_of("?")); url_components.size() == 2) {
-                std::string params{url_components.at(1)};
+        if (boost::split(url_components, url, boost::is_any_of("?")); url_components.size() == 2) {
+            std::string params{url_components.at(1)};
 
-                std::vector<std::string> params_splitted;
-                boost::split(params_splitted, params, boost::is_any_of("&"));
+            std::vector<std::string> params_splitted;
+            boost::split(params_splitted, params, boost::is_any_of("&"));
 
-                for (std::string & param : params_splitted) {
-                    std::vector<std::string> param_key_val;
+            for (std::string & param : params_splitted) {
+                std::vector<std::string> param_key_val;
 
-                    boost::split(param_key_val, param, boost::is_any_of("="));
+                boost::split(param_key_val, param, boost::is_any_of("="));
 
-                    if (param_key_val.at(0) == "start") {
-                        offset = std::stoi(param_key_val.at(1));
-                    } else if (param_key_val.at(0) == "maxItems") {
-                        limit = std::stoi(param_key_val.at(1));
-                    }
+                if (param_key_val.at(0) == "start") {
+                    offset = std::stoi(param_key_val.at(1));
+                } else if (param_key_val.at(0) == "maxItems") {
+                    limit = std::stoi(param_key_val.at(1));
                 }
             }
+        }
 
-            if (limit > 100) {
-                HttpResponse response{ConstructBadRequestResponse("Start top results must be less than 100"sv, req.version(), req.keep_alive())};
-                send(std::move(response), start_response_time);
-            }
+        if (limit > 100) {
+            HttpResponse response{ConstructBadRequestResponse("Start top results must be less than 100"sv, req.version(), req.keep_alive())};
+            send(std::move(response), start_response_time);
+            return;
+        }
 
-            HttpResponse response{ConstructOkResponse(req.version(), req.keep_alive())};
-            response.set(http::field::content_type, "application/json");
-            response.prepare_payload();
+        HttpResponse response{ConstructOkResponse(req.version(), req.keep_alive())};
+        response.set(http::field::content_type, "application/json");
+        response.prepare_payload();
 
-            send(std::move(response), start_response_time);
-        }, true));
-// *    POST, PUT, DELETE, PATCH, OPTIONS
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/records"}, http::verb::post, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("GET, HEAD"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/records"}, http::verb::put, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("GET, HEAD"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/records"}, http::verb::delete_, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("GET, HEAD"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/records"}, http::verb::patch, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("GET, HEAD"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/v1/game/records"}, http::verb::options, [&send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response{ConstructMethodNotAllowedResponse("GET, HEAD"sv, req.version(), req.keep_alive())};
-            send(std::move(response), start_response_time);
-        }));
+        send(std::move(response), start_response_time);
+    }
 
-// *    Mapping:
-// *    /api/...
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>({"/api/"}, http::verb::get, [self = this, &send, start_response_time] (http::request<Body, Allocator> && req) {
-            HttpResponse response = ConstructBadRequestResponse(json_builder::GetBadRequest_s(), req.version(), req.keep_alive());
-            send(std::move(response), start_response_time);
-        }, true));
+// *    GET {root}/...
+//  *   Cached files are answered from memory, files the cache doesn't hold are sent from the disk with sendfile
+    template <typename Body, typename Allocator, typename Send>
+    void SendFile(std::string_view path, http::request<Body, Allocator> && req, Send & send, TimePoint start_response_time) {
+        if (static_cache::AssetPtr asset = static_cache_.Find(path)) {
+            HttpAssetResponse response = ConstructAssetResponse(std::move(asset), req, req.version(), req.keep_alive());
+
+//  *   *   Large uncompressed bodies are copied to the socket by the kernel, the cached copy is sent if the file can't be opened
+            if (response.body().data.size() >= SENDFILE_MIN_SIZE && response[http::field::content_encoding].empty()) {
+                if (std::optional<HttpFileResponse> file_response = ConstructFileResponse(response)) {
+                    send(std::move(*file_response), start_response_time);
+                    return;
+                }
+            }
 
-// *    Mapping local file access:
-// *    {root}/...
-        endpoints.emplace_back(endpoint::Endpoint<Body, Allocator>(request_target, http::verb::get, [this, &send, start_response_time, request_target] (http::request<Body, Allocator> && req) {
-            sys::error_code ec;
+            send(std::move(response), start_response_time);
+            return;
+        }
 
-            HttpFileResponse response = ConstructFileResponse(root_, request_target, req.version(), req.keep_alive(), ec);
-            
-            if (ec) {
-                HttpResponse not_found_res(http::status::not_found, req.version());
+        sys::error_code ec;
 
-                not_found_res.set(http::field::content_type, http_content_type::TEXT);
-                not_found_res.body() = json_builder::GetPageNotFound_s();
-                not_found_res.keep_alive(false);
+        HttpFileResponse response = ConstructFileResponse(root_, fs::weakly_canonical(fs::path{path}), req.version(), req.keep_alive(), ec);
 
-                send(std::move(not_found_res), start_response_time);
+        if (ec) {
+            HttpResponse not_found_res(http::status::not_found, req.version());
 
-                return;
-            }
+            not_found_res.set(http::field::content_type, http_content_type::TEXT);
+            not_found_res.body() = json_builder::GetPageNotFound_s();
+            not_found_res.keep_alive(req.keep_alive());
 
-            send(std::move(response), start_response_time); 
-        }));
+            send(std::move(not_found_res), start_response_time);
 
-// *    Looking for suitable path
-        for (const endpoint::Endpoint<Body, Allocator> & endpoint : endpoints) {
-            if (endpoint.IsMatch(request_target, request.method())) {
-                endpoint.Invoke(std::move(request));
-                return;
-            }
+            return;
         }
 
         send(std::move(response), start_response_time);
     }
 
-private:
+    template <typename Send>
+    net::awaitable<void> SendRecordsFromDatabase(std::optional<app::ResultsCursor> cursor, bool cursor_mode, unsigned int offset, unsigned int limit, unsigned version, bool keep_alive, Send send, std::chrono::time_point<std::chrono::system_clock> start_response_time) {
+        try {
+            std::vector<app::GameResult> game_results = co_await db_executor_->Execute([cursor = std::move(cursor), cursor_mode, offset, limit] (app::IUnitOfWork & unit_of_work) {
+                if (cursor) {
+                    return unit_of_work.Results()->GetResultsAfter(*cursor, limit);
+                }
+
+                return unit_of_work.Results()->GetResults(limit, cursor_mode ? 0 : offset);
+            }, net::use_awaitable);
+
+            send(ConstructRecordsResponse(game_results, limit, cursor_mode, version, keep_alive), start_response_time);
+        } catch (const app::StorageUnavailableError & ex) {
+//  *   Exhausted pool: the client may retry
+            send(ConstructServiceUnavailableResponse(ex.what(), version, keep_alive), start_response_time);
+        } catch (const std::exception & ex) {
+//  *   A failed query: its text stays in the server log, the client gets a generic message
+            BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{"exception", ex.what()}, {"where", "records"}}) << logging::add_value(message_, "error");
+            send(ConstructServiceUnavailableResponse("Records are unavailable"sv, version, keep_alive), start_response_time);
+        }
+    }
+
     std::shared_ptr<model::Game> game_;
     app::Application & app_;
     loot_gen::LootGenerator & generator_;
-    std::shared_ptr<app::IUnitOfWorkFactory> unit_of_work_factory_;
-    std::vector<extra_data::MapExtraData> maps_extra_data_;
+    std::shared_ptr<app::DbExecutor> db_executor_;
+    app::Leaderboard & leaderboard_;
+    journal::Journal & journal_;
     std::shared_ptr<Strand> strand_;
     fs::path root_;
+    static_cache::StaticCache & static_cache_;
+    StatePublisher & state_publisher_;
+    static_cache::AssetPtr maps_response_;
+    MapResponses map_responses_;
+    Router router_;
 };
 
 }  // namespace http_handler
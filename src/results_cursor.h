@@ -0,0 +1,92 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace app {
+
+// Position in the records order (scores DESC, playTime ASC, name ASC, id ASC): the last result of a page.
+// The next page starts right after it, so it is read by a keyset query instead of skipping rows.
+// The result id makes the position unique, rows tied with the last one on the other columns are not skipped.
+struct ResultsCursor {
+    unsigned int scores;
+    unsigned int session_duration;
+    std::uint64_t id;
+    std::string name;
+};
+
+// The token is opaque for clients: "<scores>.<play time>.<id>.<name bytes>", everything hex encoded
+inline std::string FormatResultsCursor(const ResultsCursor & cursor) {
+    static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+    std::string token;
+    token.reserve(2 * sizeof(unsigned int) * 2 + 2 * sizeof(std::uint64_t) + 3 + cursor.name.size() * 2);
+
+    char buffer[2 * sizeof(std::uint64_t)];
+
+    auto append_number = [&token, &buffer] (auto value) {
+        auto [end, ec] = std::to_chars(std::begin(buffer), std::end(buffer), value, 16);
+        token.append(buffer, end);
+        token.push_back('.');
+    };
+
+    append_number(cursor.scores);
+    append_number(cursor.session_duration);
+    append_number(cursor.id);
+
+    for (unsigned char c : cursor.name) {
+        token.push_back(HEX_DIGITS[c >> 4]);
+        token.push_back(HEX_DIGITS[c & 0xf]);
+    }
+
+    return token;
+}
+
+inline ResultsCursor ParseResultsCursor(std::string_view token) {
+    using namespace std::literals;
+
+    auto parse_number = [&token] (auto & value) {
+        size_t dot = token.find('.');
+
+        if (dot == std::string_view::npos || dot == 0) {
+            throw std::invalid_argument("Invalid cursor"s);
+        }
+
+        auto [end, ec] = std::from_chars(token.data(), token.data() + dot, value, 16);
+
+        if (ec != std::errc{} || end != token.data() + dot) {
+            throw std::invalid_argument("Invalid cursor"s);
+        }
+
+        token.remove_prefix(dot + 1);
+    };
+
+    ResultsCursor cursor;
+    parse_number(cursor.scores);
+    parse_number(cursor.session_duration);
+    parse_number(cursor.id);
+
+    if (token.size() % 2 != 0) {
+        throw std::invalid_argument("Invalid cursor"s);
+    }
+
+    cursor.name.reserve(token.size() / 2);
+
+    for (size_t pos = 0; pos < token.size(); pos += 2) {
+        unsigned char c;
+        auto [end, ec] = std::from_chars(token.data() + pos, token.data() + pos + 2, c, 16);
+
+        if (ec != std::errc{} || end != token.data() + pos + 2) {
+            throw std::invalid_argument("Invalid cursor"s);
+        }
+
+        cursor.name.push_back(static_cast<char>(c));
+    }
+
+    return cursor;
+}
+
+} // namespace app
@@ -0,0 +1,176 @@
+#include "results_store.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+
+namespace results_store {
+
+namespace {
+
+template <typename T>
+bool Read(std::istream & in, T & value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+template <typename T>
+void Write(std::ostream & out, T value) {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+} // namespace
+
+LocalResultsStore::LocalResultsStore(const fs::path & path) : path_{path} {
+    index_ = Load();
+
+    for (const app::GameResult & result : index_) {
+        last_id_ = std::max(last_id_, result.id_);
+    }
+
+    log_.open(path_, std::ios::binary | std::ios::app);
+
+    if (!log_) {
+        throw std::runtime_error("Results store cannot be opened: " + path_.string());
+    }
+}
+
+std::vector<app::GameResult> LocalResultsStore::Load() {
+    std::vector<app::GameResult> results;
+
+    std::ifstream in(path_, std::ios::binary);
+
+    if (!in) {
+        return results;
+    }
+
+    std::uintmax_t file_size = fs::file_size(path_);
+    std::uintmax_t valid_size = 0;
+
+    while (true) {
+        std::uint64_t id;
+        std::uint32_t scores;
+        std::uint32_t session_duration;
+        std::uint32_t name_size;
+
+        if (!Read(in, id) || !Read(in, scores) || !Read(in, session_duration) || !Read(in, name_size)) {
+            break;
+        }
+
+//  *   *   A length reaching past the end of the file is a torn or corrupt record, nothing is allocated for it
+        if (name_size > file_size - valid_size - RECORD_HEADER_SIZE) {
+            break;
+        }
+
+        std::string name(name_size, '\0');
+
+        if (!in.read(name.data(), name_size)) {
+            break;
+        }
+
+        results.emplace_back(name, scores, session_duration, id);
+        valid_size += RECORD_HEADER_SIZE + name_size;
+    }
+
+    in.close();
+
+//  *   Drop a torn tail so that new records are appended right after the last complete one
+    if (file_size != valid_size) {
+        fs::resize_file(path_, valid_size);
+    }
+    log_size_ = valid_size;
+
+    std::sort(results.begin(), results.end(), app::GameResultOrder{});
+
+    return results;
+}
+
+std::vector<app::GameResult> LocalResultsStore::GetResults(size_t results_count, size_t offset) const {
+    std::shared_lock lock{m_};
+
+    size_t begin = std::min(offset, index_.size());
+    size_t end = std::min(begin + results_count, index_.size());
+
+    return std::vector<app::GameResult>(index_.begin() + begin, index_.begin() + end);
+}
+
+std::vector<app::GameResult> LocalResultsStore::GetResultsAfter(const app::ResultsCursor & cursor, size_t results_count) const {
+    std::shared_lock lock{m_};
+
+    app::GameResult last{cursor.name, cursor.scores, cursor.session_duration, cursor.id};
+    auto begin = std::upper_bound(index_.begin(), index_.end(), last, app::GameResultOrder{});
+    auto end = begin + std::min<size_t>(results_count, index_.end() - begin);
+
+    return std::vector<app::GameResult>(begin, end);
+}
+
+void LocalResultsStore::Append(std::vector<app::GameResult> results) {
+    std::sort(results.begin(), results.end(), app::GameResultOrder{});
+
+    std::unique_lock lock{m_};
+
+    if (!log_.is_open()) {
+        Rollback();
+
+        if (!log_.is_open()) {
+            throw std::runtime_error("Results store cannot be reopened: " + path_.string());
+        }
+    }
+
+    std::uintmax_t batch_size = 0;
+
+    for (const app::GameResult & result : results) {
+        Write(log_, result.id_);
+        Write(log_, static_cast<std::uint32_t>(result.scores_));
+        Write(log_, static_cast<std::uint32_t>(result.session_duration_));
+        Write(log_, static_cast<std::uint32_t>(result.name_.size()));
+        log_.write(result.name_.data(), result.name_.size());
+
+        batch_size += RECORD_HEADER_SIZE + result.name_.size();
+    }
+
+    log_.flush();
+
+    if (!log_) {
+        Rollback();
+        throw std::runtime_error("Results store write failed");
+    }
+
+    log_size_ += batch_size;
+
+    for (const app::GameResult & result : results) {
+        last_id_ = std::max(last_id_, result.id_);
+    }
+
+//  *   One merge per batch keeps inserts linear in the index size instead of per result
+    size_t old_size = index_.size();
+    index_.insert(index_.end(), std::make_move_iterator(results.begin()), std::make_move_iterator(results.end()));
+    std::inplace_merge(index_.begin(), index_.begin() + old_size, index_.end(), app::GameResultOrder{});
+}
+
+//  *   A partly written batch is cut off, otherwise every record appended after it would be unreadable.
+//  *   The log stays closed when the file can't be truncated, the next batch tries again.
+void LocalResultsStore::Rollback() {
+    log_.close();
+    log_.clear();
+
+    std::error_code ec;
+    fs::resize_file(path_, log_size_, ec);
+
+    if (!ec) {
+        log_.open(path_, std::ios::binary | std::ios::app);
+    }
+}
+
+std::uint64_t LocalResultsStore::GetLastResultId() const {
+    std::shared_lock lock{m_};
+    return last_id_;
+}
+
+size_t LocalResultsStore::Size() const {
+    std::shared_lock lock{m_};
+    return index_.size();
+}
+
+} // namespace results_store
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+#include "app.h"
+
+namespace results_store {
+
+namespace fs = std::filesystem;
+
+// Retired players kept in an append-only log on local disk, with an in-memory index in the records
+// order (scores DESC, playTime ASC, name ASC, id ASC). Replaces PostgreSQL where no database is at hand.
+//
+// Record: result id (u64), scores (u32), play time (u32), name length (u32), name bytes; native byte order.
+// A torn record at the end of the log (crash during a write) is cut off on open,
+// a batch that fails to be written is cut off right away.
+class LocalResultsStore {
+public:
+    // Bytes of a record before its name
+    static constexpr std::uintmax_t RECORD_HEADER_SIZE = sizeof(std::uint64_t) + 3 * sizeof(std::uint32_t);
+
+    explicit LocalResultsStore(const fs::path & path);
+
+    LocalResultsStore(const LocalResultsStore &) = delete;
+    LocalResultsStore & operator=(const LocalResultsStore &) = delete;
+
+    std::vector<app::GameResult> GetResults(size_t results_count, size_t offset) const;
+    std::vector<app::GameResult> GetResultsAfter(const app::ResultsCursor & cursor, size_t results_count) const;
+
+    // Appends results to the log and to the index as one batch
+    void Append(std::vector<app::GameResult> results);
+
+    std::uint64_t GetLastResultId() const;
+
+    size_t Size() const;
+
+private:
+    std::vector<app::GameResult> Load();
+    void Rollback();
+
+    fs::path path_;
+
+    mutable std::shared_mutex m_;
+    std::vector<app::GameResult> index_;
+    std::uint64_t last_id_ = 0;
+    std::ofstream log_;
+//  *   Size of the complete records in the log
+    std::uintmax_t log_size_ = 0;
+};
+
+class LocalGameResultRepository : public app::IGameResultRepository {
+public:
+    explicit LocalGameResultRepository(LocalResultsStore & store) : store_{store} {}
+
+    std::vector<app::GameResult> GetResults(unsigned int results_count = max_results_count_, unsigned int offset = 0) override {
+        return store_.GetResults(results_count, offset);
+    }
+    std::vector<app::GameResult> GetResultsAfter(const app::ResultsCursor & cursor, unsigned int results_count = max_results_count_) override {
+        return store_.GetResultsAfter(cursor, results_count);
+    }
+    std::uint64_t GetLastResultId() override {
+        return store_.GetLastResultId();
+    }
+    void AddResult(const app::GameResult & game_result) override {
+        added_.push_back(game_result);
+    }
+    void AddResults(const std::vector<app::GameResult> & game_results) override {
+        added_.insert(added_.end(), game_results.begin(), game_results.end());
+    }
+
+    // Results added in this unit of work, written on commit
+    std::vector<app::GameResult> TakeAdded() {
+        return std::exchange(added_, {});
+    }
+private:
+    static const unsigned int max_results_count_ = 100;
+
+    LocalResultsStore & store_;
+    std::vector<app::GameResult> added_;
+};
+
+class LocalUnitOfWork : public app::IUnitOfWork {
+public:
+    explicit LocalUnitOfWork(LocalResultsStore & store) : store_{store}, game_result_repos_{store} {}
+
+    ~LocalUnitOfWork() {
+        try {
+            Commit();
+        } catch (...) {
+//  *   A failed commit must not terminate the process from a destructor
+        }
+    }
+
+    app::IGameResultRepository * Results() override {
+        return &game_result_repos_;
+    }
+
+    void Commit() override {
+        std::vector<app::GameResult> added = game_result_repos_.TakeAdded();
+
+        if (!added.empty()) {
+            store_.Append(std::move(added));
+        }
+    }
+private:
+    LocalResultsStore & store_;
+    LocalGameResultRepository game_result_repos_;
+};
+
+class LocalUnitOfWorkFactory : public app::IUnitOfWorkFactory {
+public:
+    explicit LocalUnitOfWorkFactory(std::shared_ptr<LocalResultsStore> store) : store_{std::move(store)} {}
+
+    std::shared_ptr<app::IUnitOfWork> NewUnitOfWork() override {
+        return std::make_shared<LocalUnitOfWork>(*store_);
+    }
+private:
+    std::shared_ptr<LocalResultsStore> store_;
+};
+
+} // namespace results_store
@@ -0,0 +1,107 @@
+#include "results_writer.h"
+
+#include <algorithm>
+
+#include "logger.h"
+
+namespace app {
+
+ResultsWriter::ResultsWriter(std::shared_ptr<IUnitOfWorkFactory> unit_of_work_factory, Config config)
+    : unit_of_work_factory_{std::move(unit_of_work_factory)}
+    , config_{config}
+    , dropped_{metrics::Registry::Instance().GetCounter("results_dropped_total")} {
+    thread_ = std::jthread([this] (std::stop_token stop_token) {
+        Run(stop_token);
+    });
+}
+
+ResultsWriter::~ResultsWriter() {
+    Stop();
+}
+
+void ResultsWriter::Push(GameResult result) {
+    Node * node = new Node{std::move(result)};
+    node->next = head_.load(std::memory_order_relaxed);
+
+    while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+
+    if (pending_.fetch_add(1, std::memory_order_relaxed) + 1 == config_.batch_size) {
+//  *   *   Notified under the mutex, otherwise the wakeup is lost between the predicate check of the writer and its wait
+        std::lock_guard lock{wake_mutex_};
+        wake_cv_.notify_one();
+    }
+}
+
+void ResultsWriter::Stop() {
+    if (thread_.joinable()) {
+        thread_.request_stop();
+        thread_.join();
+    }
+}
+
+void ResultsWriter::Run(std::stop_token stop_token) {
+    while (!stop_token.stop_requested()) {
+        {
+            std::unique_lock lock{wake_mutex_};
+            wake_cv_.wait_for(lock, stop_token, config_.flush_interval, [this] {
+                return pending_.load(std::memory_order_relaxed) >= config_.batch_size;
+            });
+        }
+
+        Flush();
+    }
+
+    Flush();
+}
+
+std::vector<GameResult> ResultsWriter::TakeAll() {
+    Node * node = head_.exchange(nullptr, std::memory_order_acquire);
+
+    std::vector<GameResult> results;
+
+    while (node) {
+        results.emplace_back(std::move(node->result));
+
+        Node * next = node->next;
+        delete node;
+        node = next;
+    }
+
+    pending_.fetch_sub(results.size(), std::memory_order_relaxed);
+
+//  *   The stack hands results out newest first
+    std::reverse(results.begin(), results.end());
+
+    return results;
+}
+
+void ResultsWriter::Flush() {
+    std::vector<GameResult> results = TakeAll();
+    unsaved_.insert(unsaved_.end(), std::make_move_iterator(results.begin()), std::make_move_iterator(results.end()));
+
+    if (unsaved_.empty()) {
+        return;
+    }
+
+    if (unsaved_.size() > config_.max_unsaved) {
+        size_t dropped = unsaved_.size() - config_.max_unsaved;
+        unsaved_.erase(unsaved_.begin(), unsaved_.begin() + static_cast<std::ptrdiff_t>(dropped));
+        dropped_.Increment(dropped);
+
+        BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{"where", "results writer"}, {"dropped", dropped}}) << logging::add_value(message_, "error");
+    }
+
+    try {
+        auto unit_of_work = unit_of_work_factory_->NewUnitOfWork();
+        unit_of_work->Results()->AddResults(unsaved_);
+        unit_of_work->Commit();
+
+        unsaved_.clear();
+    } catch (const std::exception & ex) {
+//  *   Results stay in unsaved_ and are written with the next batch
+        BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{"exception", ex.what()}, {"where", "results writer"}, {"unsaved", unsaved_.size()}}) << logging::add_value(message_, "error");
+    }
+}
+
+} // namespace app
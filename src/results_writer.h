@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "app.h"
+#include "metrics.h"
+
+namespace app {
+
+// Writes game results to the repository on a background thread.
+// Push only links a node into a lock-free MPSC stack, so the game strand never waits
+// for the database. The writer thread drains the stack and stores the results in one
+// unit of work once batch_size results are pending or flush_interval has passed.
+// While the database is unreachable at most max_unsaved results are kept, the oldest ones are dropped.
+class ResultsWriter {
+public:
+    struct Config {
+        size_t batch_size = 256;
+        std::chrono::milliseconds flush_interval{500};
+        size_t max_unsaved = 64 * 1024;
+    };
+
+    ResultsWriter(std::shared_ptr<IUnitOfWorkFactory> unit_of_work_factory, Config config);
+    explicit ResultsWriter(std::shared_ptr<IUnitOfWorkFactory> unit_of_work_factory) : ResultsWriter(std::move(unit_of_work_factory), Config{}) {}
+
+    ResultsWriter(const ResultsWriter &) = delete;
+    ResultsWriter & operator=(const ResultsWriter &) = delete;
+
+    ~ResultsWriter();
+
+    void Push(GameResult result);
+
+    // Flushes everything pushed so far and stops the writer thread
+    void Stop();
+
+    size_t GetPendingCount() const noexcept {
+        return pending_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Node {
+        GameResult result;
+        Node * next = nullptr;
+    };
+
+    void Run(std::stop_token stop_token);
+    std::vector<GameResult> TakeAll();
+    void Flush();
+
+    std::shared_ptr<IUnitOfWorkFactory> unit_of_work_factory_;
+    Config config_;
+
+    std::atomic<Node *> head_ = nullptr;
+    std::atomic<size_t> pending_ = 0;
+
+    std::vector<GameResult> unsaved_;
+    metrics::Counter & dropped_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable_any wake_cv_;
+    std::jthread thread_;
+};
+
+} // namespace app
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <boost/beast/http/verb.hpp>
+
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace router {
+
+namespace http = boost::beast::http;
+
+/*
+ *  Route table built once at startup.
+ *
+ *  Patterns are split into segments and stored in a trie, every node keeps the methods
+ *  registered for its path and the "Allow" value listing them.
+ *  "{name}" matches one non-empty segment, a trailing "*" matches the node and everything below it
+ *  and is used only when nothing more specific has been found.
+ *
+ *  Find walks the path once and does not allocate.
+ */
+template <typename RouteId>
+class Router {
+public:
+    static constexpr size_t MAX_PARAMS = 4;
+
+    enum class Status {
+        NOT_FOUND,
+        METHOD_NOT_ALLOWED,
+        FOUND
+    };
+
+    struct Match {
+        Status status = Status::NOT_FOUND;
+        RouteId route{};
+        // Methods of the path for 405 responses
+        std::string_view allow;
+        std::array<std::string_view, MAX_PARAMS> params{};
+        size_t params_count = 0;
+    };
+
+    Router() : nodes_(1) {}
+
+    void Add(std::string_view pattern, http::verb method, RouteId route) {
+        size_t node = ROOT;
+        size_t params_count = 0;
+        bool is_prefix = false;
+
+        for (std::string_view rest = pattern; !rest.empty();) {
+            std::string_view segment = NextSegment(rest);
+
+            if (is_prefix) {
+                throw std::invalid_argument("Route \"*\" must be the last segment");
+            }
+
+            if (segment == "*") {
+                is_prefix = true;
+            } else if (segment.size() > 2 && segment.front() == '{' && segment.back() == '}') {
+                if (++params_count > MAX_PARAMS) {
+                    throw std::invalid_argument("Too many route parameters");
+                }
+                node = GetParamChild(node);
+            } else {
+                node = GetChild(node, segment);
+            }
+        }
+
+        std::vector<Method> & methods = is_prefix ? nodes_[node].prefix_methods : nodes_[node].methods;
+
+        for (const Method & m : methods) {
+            if (m.method == method) {
+                throw std::invalid_argument("Route is already registered");
+            }
+        }
+
+        methods.emplace_back(Method{method, route});
+
+        if (!is_prefix) {
+            std::string & allow = nodes_[node].allow;
+            if (!allow.empty()) {
+                allow += ", ";
+            }
+            auto name = http::to_string(method);
+            allow.append(name.data(), name.size());
+        }
+    }
+
+    // path is an absolute path without the query string
+    Match Find(std::string_view path, http::verb method) const {
+        Match match;
+
+        size_t node = ROOT;
+        size_t prefix_node = nodes_[ROOT].prefix_methods.empty() ? NONE : ROOT;
+
+        for (std::string_view rest = path; !rest.empty() && node != NONE;) {
+            std::string_view segment = NextSegment(rest);
+            size_t next = FindChild(node, segment);
+
+            if (next == NONE && !segment.empty() && nodes_[node].param_child != NONE && match.params_count < MAX_PARAMS) {
+                next = nodes_[node].param_child;
+                match.params[match.params_count++] = segment;
+            }
+
+            node = next;
+
+            if (node != NONE && !nodes_[node].prefix_methods.empty()) {
+                prefix_node = node;
+            }
+        }
+
+        if (node != NONE && !nodes_[node].methods.empty()) {
+            if (const Method * m = FindMethod(nodes_[node].methods, method)) {
+                match.status = Status::FOUND;
+                match.route = m->route;
+            } else {
+                match.status = Status::METHOD_NOT_ALLOWED;
+                match.allow = nodes_[node].allow;
+            }
+
+            return match;
+        }
+
+        match.params_count = 0;
+
+        if (prefix_node != NONE) {
+            if (const Method * m = FindMethod(nodes_[prefix_node].prefix_methods, method)) {
+                match.status = Status::FOUND;
+                match.route = m->route;
+            }
+        }
+
+        return match;
+    }
+
+private:
+    static constexpr size_t ROOT = 0;
+    static constexpr size_t NONE = static_cast<size_t>(-1);
+
+    struct Method {
+        http::verb method;
+        RouteId route;
+    };
+
+    struct Node {
+        std::vector<std::pair<std::string, size_t>> children;
+        size_t param_child = NONE;
+        std::vector<Method> methods;
+        std::vector<Method> prefix_methods;
+        std::string allow;
+    };
+
+    // Cuts the leading "/segment" off rest, "/api/v1/" gives "api", "v1" and ""
+    static std::string_view NextSegment(std::string_view & rest) {
+        if (rest.front() == '/') {
+            rest.remove_prefix(1);
+        }
+
+        size_t end = rest.find('/');
+        std::string_view segment = rest.substr(0, end);
+        rest = end == std::string_view::npos ? std::string_view{} : rest.substr(end);
+
+        return segment;
+    }
+
+    static const Method * FindMethod(const std::vector<Method> & methods, http::verb method) {
+        for (const Method & m : methods) {
+            if (m.method == method) {
+                return &m;
+            }
+        }
+
+        return nullptr;
+    }
+
+    size_t FindChild(size_t node, std::string_view segment) const {
+        for (const auto & [name, child] : nodes_[node].children) {
+            if (name == segment) {
+                return child;
+            }
+        }
+
+        return NONE;
+    }
+
+    size_t GetChild(size_t node, std::string_view segment) {
+        if (size_t child = FindChild(node, segment); child != NONE) {
+            return child;
+        }
+
+        nodes_.emplace_back();
+        nodes_[node].children.emplace_back(std::string{segment}, nodes_.size() - 1);
+
+        return nodes_.size() - 1;
+    }
+
+    size_t GetParamChild(size_t node) {
+        if (nodes_[node].param_child == NONE) {
+            nodes_.emplace_back();
+            nodes_[node].param_child = nodes_.size() - 1;
+        }
+
+        return nodes_[node].param_child;
+    }
+
+    std::vector<Node> nodes_;
+};
+
+} // namespace router
@@ -1,45 +1,371 @@
-#include "save_manager.h"
-
-#include <fstream>
-#include <filesystem>
-#include <sstream>
-
-namespace fs = std::filesystem;
-
-void save_manager::SaveToFile(std::string_view path, std::string_view content) {
-    std::string str(path.begin(), path.end());
-    fs::path path_fs(str);
-    str.append("_temp");
-    fs::path temp_path_fs(str);
-    path_fs = fs::weakly_canonical(path_fs);
-
-    std::ofstream ofs(path_fs, std::ios::out | std::ios::trunc);
-
-    ofs << content;
-    ofs.close();
-
-    if (fs::is_regular_file(temp_path_fs)) {
-        fs::rename(temp_path_fs, path_fs);
-    }
-}
-
-std::string save_manager::LoadSavedFile(std::string_view path) {
-    fs::path path_fs(path.begin(), path.end());
-    path_fs = fs::weakly_canonical(path_fs);
-    
-    std::string data;
-
-    std::ifstream ifs(path_fs, std::ios::in);
-
-    if (ifs.is_open()) {
-        char c = '\0';
-        while (ifs.get(c)) {
-            data.push_back(c);
-        }
-        
-    } else {
-        throw std::invalid_argument("Can't load file");
-    }
-
-    return data;
+#include "save_manager.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "logger.h"
+
+namespace fs = std::filesystem;
+using namespace std::literals;
+
+save_manager::SaveScheduler::SaveScheduler(Config config, Handler handler, Clock::time_point now)
+    : config_{config}
+    , handler_{std::move(handler)}
+    , deadline_{now + config_.period}
+    , started_{metrics::Registry::Instance().GetCounter("autosave_started_total")}
+    , skipped_{metrics::Registry::Instance().GetCounter("autosave_skipped_total")}
+    , failed_{metrics::Registry::Instance().GetCounter("autosave_failed_total")}
+    , duration_{metrics::Registry::Instance().GetTiming("autosave_duration_seconds")}
+    , lag_{metrics::Registry::Instance().GetTiming("autosave_lag_seconds")}
+    , dirty_{metrics::Registry::Instance().GetGauge("autosave_dirty_changes")} {
+}
+
+void save_manager::SaveScheduler::Poll(std::uint64_t state_version, Clock::time_point now) {
+    std::uint64_t dirty = state_version - saved_version_;
+    dirty_.Set(static_cast<std::int64_t>(dirty));
+
+    if (config_.period > Milliseconds::zero() && now >= deadline_) {
+//  *   How late the save starts after its deadline; a tick period at most unless saves are skipped
+        lag_.Observe(now - deadline_);
+
+        if (!Start(state_version, now)) {
+            skipped_.Increment();
+        }
+
+//  *   *   Deadlines stay on the period grid, the ones missed while the server was stalled are dropped
+        deadline_ += config_.period;
+        if (deadline_ <= now) {
+            deadline_ = now + config_.period;
+        }
+    } else if (config_.dirty_threshold > 0 && dirty >= config_.dirty_threshold) {
+        Start(state_version, now);
+    }
+}
+
+bool save_manager::SaveScheduler::Start(std::uint64_t state_version, Clock::time_point now) {
+    if (in_flight_.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    started_at_ = now;
+    saved_version_ = state_version;
+    in_flight_.store(true, std::memory_order_release);
+    started_.Increment();
+
+    handler_();
+
+    return true;
+}
+
+void save_manager::SaveScheduler::Finish(bool succeeded) {
+    duration_.Observe(Clock::now() - started_at_);
+
+    if (!succeeded) {
+        failed_.Increment();
+    }
+
+    in_flight_.store(false, std::memory_order_release);
+}
+
+save_manager::BackgroundWriter::BackgroundWriter() {
+    thread_ = std::jthread([this] (std::stop_token stop_token) {
+        Run(stop_token);
+    });
+}
+
+save_manager::BackgroundWriter::~BackgroundWriter() {
+    Stop();
+}
+
+void save_manager::BackgroundWriter::Submit(Job job) {
+    {
+        std::lock_guard lock{m_};
+        pending_ = std::move(job);
+    }
+
+    cv_.notify_one();
+}
+
+void save_manager::BackgroundWriter::Stop() {
+    if (thread_.joinable()) {
+        thread_.request_stop();
+        thread_.join();
+    }
+}
+
+void save_manager::BackgroundWriter::Run(std::stop_token stop_token) {
+    while (true) {
+        Job job;
+
+        {
+            std::unique_lock lock{m_};
+            cv_.wait(lock, stop_token, [this] {
+                return static_cast<bool>(pending_);
+            });
+
+            if (!pending_) {
+                return;
+            }
+
+            job = std::exchange(pending_, nullptr);
+        }
+
+        try {
+            job();
+        } catch (const std::exception & ex) {
+//  *   A failed save must not stop the later ones
+            BOOST_LOG_TRIVIAL(info) << logging::add_value(data_, {{"exception", ex.what()}, {"where", "autosave"}}) << logging::add_value(message_, "error");
+        }
+    }
+}
+
+save_manager::MappedFile::MappedFile(std::string_view path) {
+    std::string path_str(path.begin(), path.end());
+
+    int fd = ::open(path_str.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::invalid_argument("Can't load file");
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::invalid_argument("Can't load file");
+    }
+
+    size_ = static_cast<size_t>(st.st_size);
+
+//  *   An empty file can't be mapped, it is just an empty view
+    if (size_ > 0) {
+        data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data_ == MAP_FAILED) {
+            data_ = nullptr;
+            ::close(fd);
+            throw std::invalid_argument("Can't load file");
+        }
+
+//  *   *   The whole file is read right away and by several threads
+        ::madvise(data_, size_, MADV_WILLNEED);
+    }
+
+    ::close(fd);
+}
+
+save_manager::MappedFile::~MappedFile() {
+    if (data_) {
+        ::munmap(data_, size_);
+    }
+}
+
+namespace {
+
+void WriteAll(int fd, std::string_view data) {
+    while (!data.empty()) {
+        ssize_t written = ::write(fd, data.data(), data.size());
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "write");
+        }
+
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+}
+
+void SyncDirectory(const fs::path & file_path) {
+    fs::path dir = file_path.has_parent_path() ? file_path.parent_path() : fs::path{"."};
+
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "open " + dir.string());
+    }
+
+    int res = ::fsync(fd);
+    int error = errno;
+    ::close(fd);
+
+    if (res != 0) {
+        throw std::system_error(error, std::generic_category(), "fsync " + dir.string());
+    }
+}
+
+} // namespace
+
+save_manager::SnapshotWriter::SnapshotWriter(Config config)
+    : config_{std::move(config)}
+    , encode_time_{metrics::Registry::Instance().GetTiming("save_encode_seconds")}
+    , write_time_{metrics::Registry::Instance().GetTiming("save_write_seconds")}
+    , fsync_time_{metrics::Registry::Instance().GetTiming("save_fsync_seconds")}
+    , rename_time_{metrics::Registry::Instance().GetTiming("save_rename_seconds")}
+    , bytes_written_{metrics::Registry::Instance().GetCounter("save_bytes_written_total")}
+    , last_size_{metrics::Registry::Instance().GetGauge("save_last_size_bytes")} {
+    config_.generations = std::max(config_.generations, 1u);
+}
+
+void save_manager::SnapshotWriter::Write(std::string_view content) {
+    namespace io = boost::iostreams;
+    using Clock = std::chrono::steady_clock;
+
+    fs::path path{config_.path};
+    fs::path temp_path{config_.path + "_temp"};
+
+    int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "open " + temp_path.string());
+    }
+
+    std::uint64_t size = content.size();
+
+    try {
+        auto start = Clock::now();
+
+        if (config_.compress) {
+//  *   *   The compressed stream goes straight to the file, it is never held in memory as a whole
+            io::filtering_ostream out;
+            out.push(io::zlib_compressor(io::zlib_params(config_.compression_level)));
+            out.push(io::file_descriptor_sink(fd, io::never_close_handle));
+            out.exceptions(std::ios::badbit);
+
+            out.write(content.data(), static_cast<std::streamsize>(content.size()));
+            out.reset();
+
+            size = static_cast<std::uint64_t>(::lseek(fd, 0, SEEK_CUR));
+        } else {
+            WriteAll(fd, content);
+        }
+
+        write_time_.Observe(Clock::now() - start);
+
+        start = Clock::now();
+        if (config_.fsync != FsyncPolicy::none && ::fsync(fd) != 0) {
+            throw std::system_error(errno, std::generic_category(), "fsync " + temp_path.string());
+        }
+        fsync_time_.Observe(Clock::now() - start);
+    } catch (...) {
+        ::close(fd);
+        std::error_code ec;
+        fs::remove(temp_path, ec);
+        throw;
+    }
+
+    ::close(fd);
+
+    auto start = Clock::now();
+
+    RotateGenerations();
+    fs::rename(temp_path, path);
+
+    if (config_.fsync == FsyncPolicy::full) {
+        SyncDirectory(path);
+    }
+
+    rename_time_.Observe(Clock::now() - start);
+
+    bytes_written_.Increment(size);
+    last_size_.Set(static_cast<std::int64_t>(size));
+}
+
+void save_manager::SnapshotWriter::RotateGenerations() {
+    fs::path path{config_.path};
+
+    if (config_.generations <= 1 || !fs::is_regular_file(path)) {
+        return;
+    }
+
+    std::vector<std::string> paths = GetGenerationPaths(config_.path, config_.generations);
+
+    for (size_t i = paths.size() - 1; i > 1; --i) {
+        if (fs::is_regular_file(paths[i - 1])) {
+            fs::rename(paths[i - 1], paths[i]);
+        }
+    }
+
+//  *   The current save becomes the first old one through a hard link, so path never disappears
+    fs::remove(paths[1]);
+    fs::create_hard_link(path, paths[1]);
+}
+
+std::vector<std::string> save_manager::GetGenerationPaths(std::string_view path, unsigned generations) {
+    std::vector<std::string> paths;
+    paths.emplace_back(path);
+
+    for (unsigned i = 1; i < generations; ++i) {
+        paths.emplace_back(std::string{path} + "." + std::to_string(i));
+    }
+
+    return paths;
+}
+
+bool save_manager::IsCompressed(std::string_view data) {
+//  *   zlib header: deflate method, 32K window and a check sum making the first two bytes a multiple of 31
+    if (data.size() < 2) {
+        return false;
+    }
+
+    unsigned char cmf = static_cast<unsigned char>(data[0]);
+    unsigned char flg = static_cast<unsigned char>(data[1]);
+
+    return cmf == 0x78 && (cmf * 256 + flg) % 31 == 0;
+}
+
+std::string save_manager::Decompress(std::string_view data) {
+    namespace io = boost::iostreams;
+
+    std::string out;
+
+    try {
+        io::filtering_istream in;
+        in.push(io::zlib_decompressor());
+        in.push(io::array_source(data.data(), data.size()));
+
+        io::copy(in, io::back_inserter(out));
+    } catch (const io::zlib_error & ex) {
+        throw std::invalid_argument("Save file is damaged: "s + ex.what());
+    }
+
+    return out;
+}
+
+void save_manager::SaveToFile(std::string_view path, std::string_view content) {
+    SnapshotWriter{SnapshotWriter::Config{.path = std::string{path}}}.Write(content);
+}
+
+std::string save_manager::LoadSavedFile(std::string_view path) {
+    fs::path path_fs(path.begin(), path.end());
+    path_fs = fs::weakly_canonical(path_fs);
+    
+    std::string data;
+
+    std::ifstream ifs(path_fs, std::ios::in | std::ios::binary);
+
+    if (ifs.is_open()) {
+        data.resize(fs::file_size(path_fs));
+        ifs.read(data.data(), data.size());
+        data.resize(ifs.gcount());
+    } else {
+        throw std::invalid_argument("Can't load file");
+    }
+
+    return data;
 }
\ No newline at end of file
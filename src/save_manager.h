@@ -1,33 +1,178 @@
-#pragma once
-
-#include <chrono>
-#include <functional>
-#include <string>
-#include <string_view>
-
-namespace save_manager {
-
-class Saver {
-public:
-    using Milliseconds = std::chrono::milliseconds;
-    using Handler = std::function<void()>;
-
-    Saver(Milliseconds autosave_period, Handler handler) : autosave_period_(autosave_period), handler_(handler) {}
-
-    void Save(Milliseconds delta_time = std::chrono::milliseconds(0)) {
-        last_save_interval_ += delta_time;
-
-        if (last_save_interval_ >= autosave_period_) {
-            handler_();
-        }
-    }
-private:
-    Milliseconds autosave_period_;
-    Milliseconds last_save_interval_ = std::chrono::milliseconds(0);
-    Handler handler_;
-};
-
-void SaveToFile(std::string_view path, std::string_view content);
-std::string LoadSavedFile(std::string_view path);
-
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "metrics.h"
+
+namespace save_manager {
+
+// Decides when the game state is saved, it is polled on the game strand every tick.
+// A save is due at absolute deadlines, period after period, or earlier once the state version
+// (a counter that grows with every change, such as the journal sequence) has moved dirty_threshold
+// past the last save. Only one save runs at a time: a save that comes due while the previous one
+// is in flight is skipped, not queued.
+class SaveScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::milliseconds;
+    // Starts a save, which must call Finish when it is done
+    using Handler = std::function<void()>;
+
+    struct Config {
+        // Non-positive period: no periodic saves
+        Milliseconds period{0};
+        // Zero: no saves on the amount of changes
+        std::uint64_t dirty_threshold = 0;
+    };
+
+    SaveScheduler(Config config, Handler handler, Clock::time_point now = Clock::now());
+
+    void Poll(std::uint64_t state_version, Clock::time_point now = Clock::now());
+
+    // May be called from any thread
+    void Finish(bool succeeded = true);
+
+    bool IsInFlight() const noexcept {
+        return in_flight_.load(std::memory_order_acquire);
+    }
+
+private:
+    bool Start(std::uint64_t state_version, Clock::time_point now);
+
+    Config config_;
+    Handler handler_;
+
+    Clock::time_point deadline_;
+    std::uint64_t saved_version_ = 0;
+
+    std::atomic<bool> in_flight_ = false;
+    Clock::time_point started_at_;
+
+    metrics::Counter & started_;
+    metrics::Counter & skipped_;
+    metrics::Counter & failed_;
+    metrics::Timing & duration_;
+    metrics::Timing & lag_;
+    metrics::Gauge & dirty_;
+};
+
+// Runs save jobs one at a time on its own thread.
+// A job submitted while another one is waiting replaces it: only the latest state is worth writing.
+class BackgroundWriter {
+public:
+    using Job = std::function<void()>;
+
+    BackgroundWriter();
+
+    BackgroundWriter(const BackgroundWriter &) = delete;
+    BackgroundWriter & operator=(const BackgroundWriter &) = delete;
+
+    ~BackgroundWriter();
+
+    void Submit(Job job);
+
+    // Runs the waiting job, if any, and stops the thread
+    void Stop();
+
+private:
+    void Run(std::stop_token stop_token);
+
+    std::mutex m_;
+    std::condition_variable_any cv_;
+    Job pending_;
+    std::jthread thread_;
+};
+
+// Read-only mapping of a whole save file, so that a restore parses it in place instead of copying it
+class MappedFile {
+public:
+    // Throws std::invalid_argument if the file can't be opened
+    explicit MappedFile(std::string_view path);
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    ~MappedFile();
+
+    std::string_view Data() const noexcept {
+        return {static_cast<const char *>(data_), size_};
+    }
+
+private:
+    void * data_ = nullptr;
+    size_t size_ = 0;
+};
+
+enum class FsyncPolicy {
+    // Leaves flushing to the OS: fastest, a power loss may keep a renamed but empty file
+    none,
+    // Syncs the new file before the rename
+    file,
+    // Syncs the file and then its directory, so the rename itself survives a power loss
+    full
+};
+
+// Writes a save file crash-safely. The content goes, compressed with zlib if configured,
+// into "<path>_temp". That file is synced according to the policy and renamed over path,
+// so path always holds a complete save. The previous saves are kept as "<path>.1" ... "<path>.<generations - 1>".
+// Every phase is timed in the metrics registry (save_*_seconds).
+class SnapshotWriter {
+public:
+    struct Config {
+        std::string path;
+        bool compress = false;
+        int compression_level = 6;
+        FsyncPolicy fsync = FsyncPolicy::full;
+        unsigned generations = 1;
+    };
+
+    explicit SnapshotWriter(Config config);
+
+    // Encodes with encode() and writes the result, the encoding is timed as its own phase
+    template <typename Encode>
+    void Save(Encode && encode) {
+        auto start = std::chrono::steady_clock::now();
+        std::string content = encode();
+        encode_time_.Observe(std::chrono::steady_clock::now() - start);
+
+        Write(content);
+    }
+
+    // Throws std::system_error if the file can't be written, the previous save is kept then
+    void Write(std::string_view content);
+
+private:
+    void RotateGenerations();
+
+    Config config_;
+
+    metrics::Timing & encode_time_;
+    metrics::Timing & write_time_;
+    metrics::Timing & fsync_time_;
+    metrics::Timing & rename_time_;
+    metrics::Counter & bytes_written_;
+    metrics::Gauge & last_size_;
+};
+
+// Save files from the newest to the oldest generation
+std::vector<std::string> GetGenerationPaths(std::string_view path, unsigned generations);
+
+// Saves written with compression are zlib streams
+bool IsCompressed(std::string_view data);
+std::string Decompress(std::string_view data);
+
+// Writes content with the default SnapshotWriter settings
+void SaveToFile(std::string_view path, std::string_view content);
+std::string LoadSavedFile(std::string_view path);
+
 } //namespace save_manager
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/beast/core/file_posix.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <utility>
+
+#include <unistd.h>
+
+namespace http_server {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+/*
+ *  Response body sent from a file with sendfile(2).
+ *
+ *  The session writes the header and then lets the kernel copy the file to the socket,
+ *  the content never passes through user space. The body is meant for uncompressed files.
+ *  Any other writer (a serializer outside of the session) gets the content with pread.
+ */
+struct SendfileBody {
+    class value_type {
+    public:
+        void Open(const char * path, beast::error_code & ec) {
+            file_.open(path, beast::file_mode::read, ec);
+            if (ec) {
+                return;
+            }
+
+            offset_ = 0;
+            size_ = file_.size(ec);
+        }
+
+        bool IsOpen() const noexcept {
+            return file_.is_open();
+        }
+
+        int GetHandle() const noexcept {
+            return file_.native_handle();
+        }
+
+        std::uint64_t GetOffset() const noexcept {
+            return offset_;
+        }
+
+        // Bytes left to send from the offset
+        std::uint64_t GetSize() const noexcept {
+            return size_;
+        }
+
+        // Limits the body to size bytes from offset
+        void SetRange(std::uint64_t offset, std::uint64_t size) noexcept {
+            std::uint64_t end = offset_ + size_;
+            offset_ = std::min(offset, end);
+            size_ = std::min(size, end - offset_);
+        }
+
+        // Moves the offset after bytes that have been sent
+        void Consume(std::uint64_t bytes) noexcept {
+            bytes = std::min(bytes, size_);
+            offset_ += bytes;
+            size_ -= bytes;
+        }
+
+    private:
+        beast::file_posix file_;
+        std::uint64_t offset_ = 0;
+        std::uint64_t size_ = 0;
+    };
+
+    static std::uint64_t size(const value_type & body) noexcept {
+        return body.GetSize();
+    }
+
+    class writer {
+    public:
+        using const_buffers_type = boost::asio::const_buffer;
+
+        template <bool isRequest, class Fields>
+        writer(const http::header<isRequest, Fields> &, const value_type & body)
+            : body_(body)
+            , offset_(body.GetOffset())
+            , rest_(body.GetSize()) {
+        }
+
+        void init(beast::error_code & ec) {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(beast::error_code & ec) {
+            ec = {};
+
+            if (rest_ == 0) {
+                return boost::none;
+            }
+
+            ssize_t read = ::pread(body_.GetHandle(), buffer_.data(), std::min<std::uint64_t>(buffer_.size(), rest_), static_cast<off_t>(offset_));
+
+            if (read <= 0) {
+                ec = read < 0 ? beast::error_code{errno, boost::system::system_category()} : beast::error_code{boost::asio::error::eof};
+                return boost::none;
+            }
+
+            offset_ += static_cast<std::uint64_t>(read);
+            rest_ -= static_cast<std::uint64_t>(read);
+
+            return {{const_buffers_type{buffer_.data(), static_cast<size_t>(read)}, rest_ > 0}};
+        }
+
+    private:
+        const value_type & body_;
+        std::uint64_t offset_;
+        std::uint64_t rest_;
+        std::array<char, 16 * 1024> buffer_;
+    };
+};
+
+} // namespace http_server
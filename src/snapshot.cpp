@@ -0,0 +1,547 @@
+#include "snapshot.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+
+namespace snapshot {
+
+namespace {
+
+using namespace std::literals;
+
+constexpr std::array<std::uint32_t, 256> MakeCrc32Table() {
+    std::array<std::uint32_t, 256> table{};
+
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t crc = i;
+
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+
+        table[i] = crc;
+    }
+
+    return table;
+}
+
+constexpr std::array<std::uint32_t, 256> CRC32_TABLE = MakeCrc32Table();
+
+class Writer {
+public:
+    explicit Writer(std::string & out) : out_{out} {}
+
+    template <typename T>
+    void Put(T value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        out_.append(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    void PutString(std::string_view str) {
+        Put(static_cast<std::uint32_t>(str.size()));
+        out_.append(str);
+    }
+
+    size_t Size() const noexcept {
+        return out_.size();
+    }
+
+    // Overwrites a value written earlier at pos
+    template <typename T>
+    void Patch(size_t pos, T value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        std::memcpy(out_.data() + pos, &value, sizeof(value));
+    }
+
+    // Returns the position of the section length, which EndSection fills in
+    size_t BeginSection(SectionTag tag) {
+        Put(static_cast<std::uint32_t>(tag));
+        size_t length_pos = out_.size();
+        Put(std::uint64_t{0});
+
+        return length_pos;
+    }
+
+    void EndSection(size_t length_pos) {
+        Patch(length_pos, static_cast<std::uint64_t>(out_.size() - length_pos - sizeof(std::uint64_t)));
+    }
+
+private:
+    std::string & out_;
+};
+
+class Reader {
+public:
+    explicit Reader(std::string_view data) : data_{data} {}
+
+    template <typename T>
+    T Get() {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        T value;
+        std::memcpy(&value, GetBytes(sizeof(T)).data(), sizeof(T));
+
+        return value;
+    }
+
+    std::string_view GetString() {
+        return GetBytes(Get<std::uint32_t>());
+    }
+
+    std::string_view GetBytes(size_t size) {
+        if (data_.size() - pos_ < size) {
+            throw std::invalid_argument("Snapshot is truncated"s);
+        }
+
+        std::string_view bytes = data_.substr(pos_, size);
+        pos_ += size;
+
+        return bytes;
+    }
+
+    bool Empty() const noexcept {
+        return pos_ == data_.size();
+    }
+
+private:
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+// Contents of the RUNTIME section, it is read before the sessions and players it refers to
+struct Runtime {
+    struct Motion {
+        double speed_x;
+        double speed_y;
+        std::uint8_t direction;
+    };
+
+    Checkpoint checkpoint;
+    std::unordered_map<std::uint32_t, Motion> dogs;
+    std::unordered_map<std::int32_t, std::int64_t> join_times;
+};
+
+ItemState CaptureItem(const model::Item & item) {
+    return ItemState{item.GetId(), item.GetType().GetType(), item.GetPosition().x, item.GetPosition().y};
+}
+
+void PutItem(Writer & writer, const ItemState & item) {
+    writer.Put(item.id);
+    writer.Put(item.type);
+    writer.Put(item.x);
+    writer.Put(item.y);
+}
+
+void PutRuntime(Writer & writer, const GameState & state) {
+    size_t section = writer.BeginSection(SectionTag::RUNTIME);
+
+    writer.Put(state.game_time);
+    writer.Put(state.journal_sequence);
+
+    size_t dogs_count_pos = writer.Size();
+    writer.Put(std::uint32_t{0});
+
+    std::uint32_t dogs_count = 0;
+    for (const SessionState & session : state.sessions) {
+        for (const DogState & dog : session.dogs) {
+            writer.Put(dog.id);
+            writer.Put(dog.speed_x);
+            writer.Put(dog.speed_y);
+            writer.Put(dog.direction);
+            ++dogs_count;
+        }
+    }
+    writer.Patch(dogs_count_pos, dogs_count);
+
+    writer.Put(static_cast<std::uint32_t>(state.players.size()));
+    for (const PlayerState & player : state.players) {
+        writer.Put(player.id);
+        writer.Put(player.join_time);
+    }
+
+//  *   Appended last, so that older readers ignore it
+    writer.Put(state.time_without_loot);
+
+    writer.EndSection(section);
+}
+
+void PutSession(Writer & writer, const SessionState & session) {
+    size_t section = writer.BeginSection(SectionTag::SESSION);
+
+    writer.Put(session.id);
+    writer.PutString(session.map_id);
+
+    writer.Put(static_cast<std::uint32_t>(session.dogs.size()));
+
+    auto dog_item = session.dog_items.begin();
+    for (const DogState & dog : session.dogs) {
+        writer.Put(dog.id);
+        writer.Put(dog.x);
+        writer.Put(dog.y);
+
+        writer.Put(dog.items_count);
+        for (std::uint32_t i = 0; i < dog.items_count; ++i, ++dog_item) {
+            PutItem(writer, *dog_item);
+        }
+    }
+
+    writer.Put(static_cast<std::uint32_t>(session.items.size()));
+    for (const ItemState & item : session.items) {
+        PutItem(writer, item);
+    }
+
+    writer.EndSection(section);
+}
+
+void PutPlayers(Writer & writer, const GameState & state) {
+    size_t section = writer.BeginSection(SectionTag::PLAYERS);
+
+    writer.Put(state.next_player_id);
+    writer.Put(static_cast<std::uint32_t>(state.players.size()));
+
+    for (const PlayerState & player : state.players) {
+        writer.Put(player.id);
+        writer.Put(player.session_id);
+        writer.Put(player.scores);
+        writer.PutString(app::TokenView(player.token));
+        writer.PutString(player.name);
+    }
+
+    writer.EndSection(section);
+}
+
+// Item types of every map by type id, so that items are restored without scanning the type list
+using ItemTypes = std::unordered_map<int, model::ItemType>;
+
+model::Item GetItem(Reader & reader, const ItemTypes & item_types) {
+    std::int32_t id = reader.Get<std::int32_t>();
+    std::int32_t type_id = reader.Get<std::int32_t>();
+    std::int32_t x = reader.Get<std::int32_t>();
+    std::int32_t y = reader.Get<std::int32_t>();
+
+    auto type = item_types.find(type_id);
+    if (type == item_types.end()) {
+        throw std::invalid_argument("Snapshot refers to an unknown item type"s);
+    }
+
+    return model::Item(id, type->second, model::Point{x, y});
+}
+
+void GetRuntime(Reader & reader, Runtime & runtime) {
+    runtime.checkpoint.game_time = std::chrono::milliseconds{reader.Get<std::int64_t>()};
+    runtime.checkpoint.journal_sequence = reader.Get<std::uint64_t>();
+
+    std::uint32_t dogs_count = reader.Get<std::uint32_t>();
+    for (std::uint32_t i = 0; i < dogs_count; ++i) {
+        std::uint32_t id = reader.Get<std::uint32_t>();
+        double speed_x = reader.Get<double>();
+        double speed_y = reader.Get<double>();
+        std::uint8_t direction = reader.Get<std::uint8_t>();
+
+        runtime.dogs.insert_or_assign(id, Runtime::Motion{speed_x, speed_y, direction});
+    }
+
+    std::uint32_t players_count = reader.Get<std::uint32_t>();
+    for (std::uint32_t i = 0; i < players_count; ++i) {
+        std::int32_t id = reader.Get<std::int32_t>();
+        runtime.join_times.insert_or_assign(id, reader.Get<std::int64_t>());
+    }
+
+    if (!reader.Empty()) {
+        runtime.checkpoint.time_without_loot = std::chrono::milliseconds{reader.Get<std::int64_t>()};
+    }
+}
+
+// Reads the head of a SESSION section and creates the session, the rest is read by GetSession
+model::GameSession * OpenSession(Reader & reader, model::Game & game) {
+    reader.Get<std::uint32_t>();
+    std::string_view map_id = reader.GetString();
+
+    model::Map * map = const_cast<model::Map *>(game.FindMap(model::Map::Id{std::string{map_id}}));
+    if (!map) {
+        throw std::invalid_argument("Snapshot refers to an unknown map"s);
+    }
+
+    return game.NewSession(map);
+}
+
+// Touches nothing but the session, so sessions are read in parallel
+void GetSession(Reader & reader, model::GameSession & session, const Runtime & runtime) {
+    ItemTypes item_types;
+    for (const model::ItemType & type : session.GetMap()->GetItemsTypes()) {
+        item_types.emplace(type.GetType(), type);
+    }
+
+    std::uint32_t dogs_count = reader.Get<std::uint32_t>();
+    session.GetDogs().reserve(session.GetDogs().size() + dogs_count);
+
+    for (std::uint32_t i = 0; i < dogs_count; ++i) {
+        std::uint32_t id = reader.Get<std::uint32_t>();
+        double x = reader.Get<double>();
+        double y = reader.Get<double>();
+
+        model::Dog & dog = session.GetDogs().emplace_back(id, model::Vector2{x, y});
+
+        if (auto motion = runtime.dogs.find(id); motion != runtime.dogs.end()) {
+            dog.SetSpeed(model::Vector2{motion->second.speed_x, motion->second.speed_y});
+            dog.SetDirection(static_cast<model::Direction>(motion->second.direction));
+        }
+
+        std::uint32_t items_count = reader.Get<std::uint32_t>();
+        for (std::uint32_t j = 0; j < items_count; ++j) {
+            dog.AddItem(GetItem(reader, item_types));
+        }
+    }
+
+    std::uint32_t items_count = reader.Get<std::uint32_t>();
+    session.GetItems().reserve(session.GetItems().size() + items_count);
+
+    for (std::uint32_t i = 0; i < items_count; ++i) {
+        session.GetItems().emplace_back(GetItem(reader, item_types));
+    }
+}
+
+void GetPlayers(Reader & reader, const Runtime & runtime) {
+    app::PlayersManager & players_manager = app::PlayersManager::Instance();
+
+    players_manager.SetNextPlayerId(reader.Get<std::int32_t>());
+
+    std::uint32_t count = reader.Get<std::uint32_t>();
+
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::int32_t id = reader.Get<std::int32_t>();
+        std::uint32_t session_id = reader.Get<std::uint32_t>();
+        std::uint32_t scores = reader.Get<std::uint32_t>();
+        std::string_view token = reader.GetString();
+        std::string_view name = reader.GetString();
+
+        auto join_time = runtime.join_times.find(id);
+        std::chrono::milliseconds join_time_ms{join_time != runtime.join_times.end() ? join_time->second : 0};
+
+        auto player = std::make_shared<app::Player>(app::ParseToken(token), id, std::string{name}, session_id, join_time_ms);
+        player->AddScores(scores);
+        players_manager.AddPlayer(std::move(player));
+    }
+}
+
+// Calls fn(i) for every i below count on up to one thread per core and rethrows the first failure
+template <typename Fn>
+void ParallelFor(size_t count, Fn && fn) {
+    size_t threads_count = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+
+    if (threads_count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    auto worker = [&] {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard lock{error_mutex};
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+
+    {
+        std::vector<std::jthread> threads;
+        threads.reserve(threads_count - 1);
+
+        for (size_t i = 1; i < threads_count; ++i) {
+            threads.emplace_back(worker);
+        }
+
+        worker();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace
+
+std::uint32_t Crc32(std::string_view data, std::uint32_t crc) {
+    crc = ~crc;
+
+    for (unsigned char c : data) {
+        crc = CRC32_TABLE[(crc ^ c) & 0xff] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+bool IsSnapshot(std::string_view data) {
+    std::uint32_t magic;
+
+    if (data.size() < sizeof(magic)) {
+        return false;
+    }
+
+    std::memcpy(&magic, data.data(), sizeof(magic));
+
+    return magic == MAGIC;
+}
+
+GameState CaptureGame(model::Game & game, const app::PlayersManager & players_manager) {
+    GameState state;
+    state.sessions.reserve(game.GetSessions().size());
+
+    for (model::GameSession & session : game.GetSessions()) {
+        SessionState & session_state = state.sessions.emplace_back();
+
+        session_state.id = session.GetId();
+        session_state.map_id = *session.GetMap()->GetId();
+
+        session_state.dogs.reserve(session.GetDogs().size());
+        for (const model::Dog & dog : session.GetDogs()) {
+            session_state.dogs.push_back(DogState{dog.GetId(), dog.GetPosition().x, dog.GetPosition().y, dog.GetSpeed().x, dog.GetSpeed().y,
+                static_cast<std::uint8_t>(dog.GetDirection()), static_cast<std::uint32_t>(dog.GetItems().size())});
+
+            for (const model::Item & item : dog.GetItems()) {
+                session_state.dog_items.push_back(CaptureItem(item));
+            }
+        }
+
+        session_state.items.reserve(session.GetItems().size());
+        for (const model::Item & item : session.GetItems()) {
+            session_state.items.push_back(CaptureItem(item));
+        }
+    }
+
+    state.next_player_id = players_manager.GetNextPlayerId();
+
+    players_manager.ForEachPlayer([&state] (const app::Player & player) {
+        state.players.push_back(PlayerState{player.GetPlayerId(), player.GetSessionId(), player.GetScores(), app::ParseToken(player.GetToken()), player.GetPlayerName(),
+            player.GetJoinTime().count()});
+    });
+
+    return state;
+}
+
+std::string SerializeState(const GameState & state) {
+    size_t estimated_size = HEADER_SIZE + 64 + state.players.size() * 76;
+    for (const SessionState & session : state.sessions) {
+        estimated_size += 64 + session.dogs.size() * 45 + (session.dog_items.size() + session.items.size()) * 16;
+    }
+
+    std::string out;
+    out.reserve(estimated_size);
+
+    Writer writer{out};
+
+    writer.Put(MAGIC);
+    writer.Put(VERSION);
+    writer.Put(std::uint32_t{0});
+    writer.Put(std::uint32_t{0});
+    writer.Put(std::uint64_t{0});
+
+    PutRuntime(writer, state);
+
+    for (const SessionState & session : state.sessions) {
+        PutSession(writer, session);
+    }
+
+    PutPlayers(writer, state);
+
+    std::string_view payload = std::string_view{out}.substr(HEADER_SIZE);
+    writer.Patch(12, Crc32(payload));
+    writer.Patch(16, static_cast<std::uint64_t>(payload.size()));
+
+    return out;
+}
+
+std::string SerializeGame(model::Game & game, const app::PlayersManager & players_manager) {
+    return SerializeState(CaptureGame(game, players_manager));
+}
+
+Checkpoint DeserializeGame(std::string_view data, model::Game & game) {
+    Reader header{data.substr(0, std::min(data.size(), HEADER_SIZE))};
+
+    if (header.Get<std::uint32_t>() != MAGIC) {
+        throw std::invalid_argument("Not a snapshot"s);
+    }
+
+    if (header.Get<std::uint32_t>() != VERSION) {
+        throw std::invalid_argument("Unsupported snapshot version"s);
+    }
+
+    header.Get<std::uint32_t>();
+    std::uint32_t crc = header.Get<std::uint32_t>();
+    std::uint64_t payload_size = header.Get<std::uint64_t>();
+
+    std::string_view payload = data.substr(HEADER_SIZE);
+
+    if (payload.size() != payload_size) {
+        throw std::invalid_argument("Snapshot is truncated"s);
+    }
+
+    if (Crc32(payload) != crc) {
+        throw std::invalid_argument("Snapshot checksum mismatch"s);
+    }
+
+    Reader reader{payload};
+    Runtime runtime;
+    std::vector<Reader> sessions;
+    std::vector<Reader> players;
+
+    while (!reader.Empty()) {
+        SectionTag tag = static_cast<SectionTag>(reader.Get<std::uint32_t>());
+        Reader section{reader.GetBytes(reader.Get<std::uint64_t>())};
+
+        switch (tag) {
+            case SectionTag::RUNTIME:
+                GetRuntime(section, runtime);
+                break;
+            case SectionTag::SESSION:
+                sessions.push_back(section);
+                break;
+            case SectionTag::PLAYERS:
+                players.push_back(section);
+                break;
+            default:
+//  *   Sections of a newer writer are skipped
+                break;
+        }
+    }
+
+//  *   Sessions are created first: the session list of the game must not change while they are filled.
+//  *   Creating one may move the others, so positions are kept until the list is complete
+    std::vector<size_t> session_indexes;
+    session_indexes.reserve(sessions.size());
+
+    for (Reader & section : sessions) {
+        session_indexes.push_back(OpenSession(section, game) - game.GetSessions().data());
+    }
+
+//  *   Sessions are independent and PlayersManager is sharded, so every section is read by its own task
+    ParallelFor(sessions.size() + players.size(), [&] (size_t i) {
+        if (i < sessions.size()) {
+            GetSession(sessions[i], game.GetSessions()[session_indexes[i]], runtime);
+        } else {
+            GetPlayers(players[i - sessions.size()], runtime);
+        }
+    });
+
+    return runtime.checkpoint;
+}
+
+} // namespace snapshot
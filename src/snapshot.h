@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "model.h"
+#include "app.h"
+
+// Binary save file format.
+//
+// Header (24 bytes): magic "GSNP", version, flags, CRC-32 of the payload, payload size.
+// Payload: sections, each one is a tag, a payload length and the section data, so a reader
+// may skip sections it does not know. There is one SESSION section per game session and
+// one PLAYERS section. The RUNTIME section comes first and keeps what the other sections lack:
+// the game clock, the journal position, dog motion, join times and the loot generator time.
+// Numbers are stored in the byte order of the host (little endian on every platform the server is built for).
+namespace snapshot {
+
+inline constexpr std::uint32_t MAGIC = 0x504e5347;  // "GSNP"
+inline constexpr std::uint32_t VERSION = 1;
+inline constexpr size_t HEADER_SIZE = 24;
+
+enum class SectionTag : std::uint32_t {
+    SESSION = 1,
+    PLAYERS = 2,
+    RUNTIME = 3
+};
+
+// Point-in-time copy of everything a snapshot contains, in flat arrays of plain values.
+// It is captured on the game strand and encoded elsewhere, so that the strand only pays for the copy.
+struct ItemState {
+    std::int32_t id;
+    std::int32_t type;
+    std::int32_t x;
+    std::int32_t y;
+};
+
+struct DogState {
+    std::uint32_t id;
+    double x;
+    double y;
+    double speed_x;
+    double speed_y;
+    std::uint8_t direction;
+//  *   The dog's items are the next items_count entries of SessionState::dog_items
+    std::uint32_t items_count;
+};
+
+struct SessionState {
+    std::uint32_t id;
+    std::string map_id;
+    std::vector<DogState> dogs;
+    std::vector<ItemState> dog_items;
+    std::vector<ItemState> items;
+};
+
+struct PlayerState {
+    std::int32_t id;
+    std::uint32_t session_id;
+    std::uint32_t scores;
+    app::Token token;
+    std::string name;
+    std::int64_t join_time;
+};
+
+struct GameState {
+    std::vector<SessionState> sessions;
+    std::vector<PlayerState> players;
+    std::int32_t next_player_id = 0;
+//  *   Set by the caller, the game does not know them
+    std::int64_t game_time = 0;
+    std::uint64_t journal_sequence = 0;
+    std::int64_t time_without_loot = 0;
+};
+
+// Game clock, journal position and loot generator time a snapshot was taken at.
+// Older save files lack them, they are zero then.
+struct Checkpoint {
+    std::chrono::milliseconds game_time{0};
+    std::uint64_t journal_sequence = 0;
+    std::chrono::milliseconds time_without_loot{0};
+};
+
+// IEEE 802.3 CRC-32
+std::uint32_t Crc32(std::string_view data, std::uint32_t crc = 0);
+
+bool IsSnapshot(std::string_view data);
+
+// Must run where the game is not modified concurrently (on the game strand)
+GameState CaptureGame(model::Game & game, const app::PlayersManager & players_manager = app::PlayersManager::Instance());
+
+std::string SerializeState(const GameState & state);
+
+std::string SerializeGame(model::Game & game, const app::PlayersManager & players_manager = app::PlayersManager::Instance());
+
+// Restores sessions into game and players into PlayersManager.
+// Throws std::invalid_argument if data is not a valid snapshot.
+Checkpoint DeserializeGame(std::string_view data, model::Game & game);
+
+} // namespace snapshot
@@ -0,0 +1,70 @@
+#include "state_publisher.h"
+
+#include <algorithm>
+#include <string>
+
+#include "app.h"
+#include "json_builder.h"
+
+namespace http_handler {
+
+StatePublisher::StatePublisher()
+    : serialized_{metrics::Registry::Instance().GetCounter("ws_states_serialized_total")}
+    , subscribers_gauge_{metrics::Registry::Instance().GetGauge("ws_subscribers")} {
+}
+
+bool StatePublisher::Subscribe(int player_id, std::weak_ptr<Socket> socket) {
+    std::shared_ptr<app::Player> player = app::PlayersManager::Instance().GetPlayerById(player_id);
+
+    if (!player) {
+        return false;
+    }
+
+    subscribers_[player->GetSessionId()].emplace_back(Subscriber{player_id, std::move(socket)});
+    subscribers_gauge_.Add();
+
+    return true;
+}
+
+void StatePublisher::Publish(model::Game & game) {
+    app::PlayersManager & players_manager = app::PlayersManager::Instance();
+
+    for (auto it = subscribers_.begin(); it != subscribers_.end();) {
+        auto & [session_id, subscribers] = *it;
+        model::GameSession * session = game.GetSessionById(session_id);
+
+//  *   Closed sockets are forgotten, sockets of players that have left are closed
+        size_t removed = std::erase_if(subscribers, [session, &players_manager] (const Subscriber & subscriber) {
+            std::shared_ptr<Socket> socket = subscriber.socket.lock();
+            if (!socket) {
+                return true;
+            }
+
+            if (!session || !players_manager.GetPlayerById(subscriber.player_id)) {
+                socket->Close();
+                return true;
+            }
+
+            return false;
+        });
+        subscribers_gauge_.Sub(static_cast<std::int64_t>(removed));
+
+        if (subscribers.empty()) {
+            it = subscribers_.erase(it);
+            continue;
+        }
+
+        auto frame = std::make_shared<const std::string>(json_builder::GetPlayersInfo_s(session));
+        serialized_.Increment();
+
+        for (const Subscriber & subscriber : subscribers) {
+            if (std::shared_ptr<Socket> socket = subscriber.socket.lock()) {
+                socket->Send(frame);
+            }
+        }
+
+        ++it;
+    }
+}
+
+} // namespace http_handler
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "metrics.h"
+#include "model.h"
+#include "websocket_session.h"
+
+namespace http_handler {
+
+// Pushes the game state to WebSocket subscribers after every tick.
+// The state of a session is serialized once and the same frame is sent to all its subscribers.
+// Sockets of retired players are closed. Must be used on the game strand only.
+class StatePublisher {
+public:
+    using Socket = http_server::WebSocketSession;
+
+    StatePublisher();
+
+    StatePublisher(const StatePublisher &) = delete;
+    StatePublisher & operator=(const StatePublisher &) = delete;
+
+    // The socket gets the state of the player's session, returns false if the player is not in the game
+    bool Subscribe(int player_id, std::weak_ptr<Socket> socket);
+
+    void Publish(model::Game & game);
+
+private:
+    struct Subscriber {
+        int player_id;
+        std::weak_ptr<Socket> socket;
+    };
+
+    std::map<unsigned int, std::vector<Subscriber>> subscribers_;
+
+    metrics::Counter & serialized_;
+    metrics::Gauge & subscribers_gauge_;
+};
+
+} // namespace http_handler
@@ -0,0 +1,235 @@
+#include "static_cache.h"
+
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+
+#include "http_content_type.h"
+
+namespace static_cache {
+
+namespace io = boost::iostreams;
+
+namespace {
+
+// FNV-1a, the ETag only has to change with the content
+std::uint64_t Hash(std::string_view data) {
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (unsigned char c : data) {
+        hash = (hash ^ c) * 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+void AppendHex(std::string & out, std::uint64_t value) {
+    char text[16];
+    auto [end, ec] = std::to_chars(std::begin(text), std::end(text), value, 16);
+    out.append(text, end);
+}
+
+std::string MakeEtag(std::string_view content, std::string_view suffix) {
+    std::string etag{"\""};
+    AppendHex(etag, Hash(content));
+    etag += '-';
+    AppendHex(etag, content.size());
+    etag += suffix;
+    etag += '"';
+
+    return etag;
+}
+
+std::string Compress(std::string_view content, Encoding encoding) {
+    std::string compressed;
+
+    io::filtering_ostream out;
+    if (encoding == Encoding::GZIP) {
+        out.push(io::gzip_compressor(io::gzip_params(io::gzip::best_compression)));
+    } else {
+        out.push(io::zlib_compressor(io::zlib_params(io::zlib::best_compression)));
+    }
+    out.push(io::back_inserter(compressed));
+    out.exceptions(std::ios::badbit);
+
+    out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    out.reset();
+
+    return compressed;
+}
+
+//  *   A variant is kept when it saves at least an eighth of the content, images and archives are sent as they are
+void SetVariant(Asset::Variant & variant, const Asset::Variant & identity, Encoding encoding, std::string_view suffix) {
+    std::string compressed = Compress(identity.data, encoding);
+
+    if (compressed.size() + identity.data.size() / 8 < identity.data.size()) {
+        variant.data = std::move(compressed);
+        variant.etag = identity.etag;
+        variant.etag.insert(variant.etag.size() - 1, suffix);
+    }
+}
+
+} // namespace
+
+StaticCache::StaticCache(fs::path root, Config config)
+    : root_{std::move(root)}
+    , config_{config}
+    , hits_{metrics::Registry::Instance().GetCounter("static_cache_hits_total")}
+    , misses_{metrics::Registry::Instance().GetCounter("static_cache_misses_total")}
+    , reloads_{metrics::Registry::Instance().GetCounter("static_cache_reloads_total")}
+    , memory_{metrics::Registry::Instance().GetGauge("static_cache_bytes")} {
+}
+
+void StaticCache::Preload() {
+    if (config_.max_total_size == 0) {
+        return;
+    }
+
+    std::error_code ec;
+    Clock::time_point now = Clock::now();
+
+    for (fs::recursive_directory_iterator it{root_, ec}, end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec)) {
+            continue;
+        }
+
+        Load("/" + it->path().lexically_relative(root_).generic_string(), now);
+    }
+}
+
+AssetPtr StaticCache::Find(std::string_view path) {
+    if (config_.max_total_size == 0) {
+        return nullptr;
+    }
+
+    std::string key{path};
+    if (key.empty() || key.back() == '/') {
+        key += "index.html";
+    }
+
+    Clock::time_point now = Clock::now();
+    AssetPtr cached;
+
+    {
+        std::shared_lock lock{mutex_};
+
+        if (auto it = entries_.find(key); it != entries_.end()) {
+            Entry & entry = *it->second;
+            Clock::rep next_check = entry.next_check.load(std::memory_order_relaxed);
+            Clock::rep next_after_now = (now + config_.check_interval).time_since_epoch().count();
+
+//  *   *   Only one of the requests coming after the interval compares the file with the disk
+            if (now.time_since_epoch().count() < next_check
+                || !entry.next_check.compare_exchange_strong(next_check, next_after_now, std::memory_order_relaxed)) {
+                hits_.Increment();
+                return entry.asset;
+            }
+
+            cached = entry.asset;
+        }
+    }
+
+    if (cached) {
+        fs::path file = root_;
+        file += key;
+
+        std::error_code ec;
+        fs::file_time_type mtime = fs::last_write_time(file, ec);
+
+        if (!ec && mtime == cached->mtime && fs::file_size(file, ec) == cached->identity.data.size() && !ec) {
+            hits_.Increment();
+            return cached;
+        }
+
+        reloads_.Increment();
+    } else {
+        misses_.Increment();
+    }
+
+    return Load(key, now);
+}
+
+Asset StaticCache::MakeAsset(std::string_view extension, std::string content, size_t min_compress_size) {
+    Asset asset;
+    asset.content_type = http_content_type::GetContentTypeByExtension(extension);
+    asset.identity.etag = MakeEtag(content, {});
+    asset.identity.data = std::move(content);
+
+    if (asset.identity.data.size() >= min_compress_size) {
+        SetVariant(asset.gzip, asset.identity, Encoding::GZIP, "-gzip");
+        SetVariant(asset.deflate, asset.identity, Encoding::DEFLATE, "-deflate");
+    }
+
+    return asset;
+}
+
+// Files are read outside of the lock, two requests may load the same file and the last one is kept
+AssetPtr StaticCache::Load(const std::string & key, Clock::time_point now) {
+    fs::path file = root_;
+    file += key;
+
+    AssetPtr asset;
+
+    std::error_code ec;
+    bool regular = fs::is_regular_file(file, ec);
+    std::uintmax_t size = regular ? fs::file_size(file, ec) : 0;
+    fs::file_time_type mtime = regular && !ec ? fs::last_write_time(file, ec) : fs::file_time_type{};
+
+//  *   The content alone has to fit into the budget, otherwise the file is not read at all
+    bool fits = false;
+    if (regular && !ec && size <= config_.max_file_size) {
+        std::shared_lock lock{mutex_};
+
+        auto it = entries_.find(key);
+        std::uintmax_t replaced_size = it != entries_.end() ? it->second->asset->GetMemorySize() : 0;
+        fits = total_size_ - replaced_size + size <= config_.max_total_size;
+    }
+
+    if (fits) {
+        std::ifstream in{file, std::ios::binary};
+        std::string content{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+
+        if (in && fs::is_regular_file(file, ec)) {
+            Asset loaded = MakeAsset(file.extension().native(), std::move(content), config_.min_compress_size);
+            loaded.path = file;
+            loaded.mtime = mtime;
+            asset = std::make_shared<const Asset>(std::move(loaded));
+        }
+    }
+
+    std::unique_lock lock{mutex_};
+
+    auto it = entries_.find(key);
+    std::uintmax_t replaced_size = it != entries_.end() ? it->second->asset->GetMemorySize() : 0;
+
+//  *   A file that is gone, too large or over the budget is served from the disk
+    if (!asset || total_size_ - replaced_size + asset->GetMemorySize() > config_.max_total_size) {
+        if (it != entries_.end()) {
+            entries_.erase(it);
+            total_size_ -= replaced_size;
+            memory_.Set(static_cast<std::int64_t>(total_size_));
+        }
+
+        return nullptr;
+    }
+
+    if (it == entries_.end()) {
+        it = entries_.emplace(key, std::make_unique<Entry>()).first;
+    }
+
+    it->second->asset = asset;
+    it->second->next_check.store((now + config_.check_interval).time_since_epoch().count(), std::memory_order_relaxed);
+
+    total_size_ = total_size_ - replaced_size + asset->GetMemorySize();
+    memory_.Set(static_cast<std::int64_t>(total_size_));
+
+    return asset;
+}
+
+} // namespace static_cache
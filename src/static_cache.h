@@ -0,0 +1,163 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/optional.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "metrics.h"
+
+// In-memory cache of the static files.
+//
+// A cached file keeps its content, its gzip and deflate variants when they are noticeably smaller,
+// its content type and a strong ETag for every variant. Files are loaded at startup and on their first request,
+// a file is compared with the disk (modification time and size) at most once per check_interval
+// and is reloaded when it has changed. Assets are immutable, a response keeps the one it was built from.
+namespace static_cache {
+
+namespace fs = std::filesystem;
+namespace http = boost::beast::http;
+
+enum class Encoding {
+    IDENTITY,
+    GZIP,
+    DEFLATE
+};
+
+struct Asset {
+    struct Variant {
+        std::string data;
+        std::string etag;
+    };
+
+    std::string_view content_type;
+    Variant identity;
+    // Empty data when compression does not pay off
+    Variant gzip;
+    Variant deflate;
+
+    fs::path path;
+    fs::file_time_type mtime;
+
+    bool HasVariant(Encoding encoding) const noexcept {
+        return encoding == Encoding::IDENTITY || !GetVariant(encoding).data.empty();
+    }
+
+    const Variant & GetVariant(Encoding encoding) const noexcept {
+        switch (encoding) {
+            case Encoding::GZIP:
+                return gzip;
+            case Encoding::DEFLATE:
+                return deflate;
+            default:
+                return identity;
+        }
+    }
+
+    size_t GetMemorySize() const noexcept {
+        return identity.data.size() + gzip.data.size() + deflate.data.size();
+    }
+};
+
+using AssetPtr = std::shared_ptr<const Asset>;
+
+// Response body sending a part of a cached asset, the asset is kept alive until the response is written
+struct AssetBody {
+    struct value_type {
+        AssetPtr asset;
+        std::string_view data;
+    };
+
+    static std::uint64_t size(const value_type & body) noexcept {
+        return body.data.size();
+    }
+
+    class writer {
+    public:
+        using const_buffers_type = boost::asio::const_buffer;
+
+        template <bool isRequest, class Fields>
+        writer(const http::header<isRequest, Fields> &, const value_type & body) : body_(body) {
+        }
+
+        void init(boost::system::error_code & ec) {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(boost::system::error_code & ec) {
+            ec = {};
+
+            if (sent_) {
+                return boost::none;
+            }
+            sent_ = true;
+
+            return {{boost::asio::const_buffer{body_.data.data(), body_.data.size()}, false}};
+        }
+
+    private:
+        const value_type & body_;
+        bool sent_ = false;
+    };
+};
+
+class StaticCache {
+public:
+    struct Config {
+        // Larger files are not cached and are sent from the disk
+        std::uintmax_t max_file_size = 16 * 1024 * 1024;
+        // Memory taken by all the variants, files that don't fit are sent from the disk. 0 turns the cache off
+        std::uintmax_t max_total_size = 256 * 1024 * 1024;
+        // Smaller files are not compressed
+        size_t min_compress_size = 256;
+        std::chrono::milliseconds check_interval{1000};
+    };
+
+    StaticCache(fs::path root, Config config);
+
+    StaticCache(const StaticCache &) = delete;
+    StaticCache & operator=(const StaticCache &) = delete;
+
+    // Loads every file under the root that fits
+    void Preload();
+
+    // path is a normalized absolute request path, "/dir/" stands for "/dir/index.html".
+    // Returns nullptr if it is not a regular file under the root or the file is not cached.
+    AssetPtr Find(std::string_view path);
+
+    // Builds an asset from the file content
+    static Asset MakeAsset(std::string_view extension, std::string content, size_t min_compress_size);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        AssetPtr asset;
+        std::atomic<Clock::rep> next_check;
+    };
+
+    AssetPtr Load(const std::string & key, Clock::time_point now);
+
+    fs::path root_;
+    Config config_;
+
+    std::shared_mutex mutex_;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries_;
+    std::uintmax_t total_size_ = 0;
+
+    metrics::Counter & hits_;
+    metrics::Counter & misses_;
+    metrics::Counter & reloads_;
+    metrics::Gauge & memory_;
+};
+
+} // namespace static_cache
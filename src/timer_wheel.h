@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace timer_wheel {
+
+/*
+ *  Hierarchical timer wheel with at most one deadline per id.
+ *  The cost of Advance depends on the number of occupied slots passed and timers fired,
+ *  not on the number of timers registered or on the time elapsed.
+ *
+ *  Time is measured in integer wheel ticks (e.g. milliseconds).
+ *  Cancellation is lazy: the entry stays in its slot and is dropped when reached
+ *  if its generation is outdated.
+ */
+template <typename Id>
+class HierarchicalTimerWheel {
+public:
+    using Time = std::uint64_t;
+
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr size_t SLOTS_COUNT = size_t{1} << SLOT_BITS;
+    static constexpr size_t LEVELS_COUNT = 4;
+
+    explicit HierarchicalTimerWheel(Time now = 0) : now_(now) {}
+
+    // Sets (or moves) the timer of id to deadline
+    void Schedule(Id id, Time deadline) {
+        std::uint64_t generation = ++last_generation_;
+        generations_[id] = generation;
+
+        Insert(Entry{id, deadline, generation});
+    }
+
+    void Cancel(Id id) {
+        generations_.erase(id);
+    }
+
+    bool IsScheduled(Id id) const {
+        return generations_.contains(id);
+    }
+
+    size_t Size() const noexcept {
+        return generations_.size();
+    }
+
+    Time GetTime() const noexcept {
+        return now_;
+    }
+
+    // Moves the wheel to now and calls on_expired(id) for every timer with deadline <= now
+    template <typename Fn>
+    void Advance(Time now, Fn && on_expired) {
+        if (now <= now_ && expired_.empty()) {
+            return;
+        }
+
+        FireEntries(expired_, on_expired);
+
+        if (generations_.empty()) {
+            Clear();
+            now_ = std::max(now_, now);
+            return;
+        }
+
+//  *   Slots without entries are skipped, the wheel only stops where a slot is fired or cascaded
+        while (now_ < now) {
+            now_ = std::min(NextEventTime(), now);
+
+            if ((now_ & SLOT_MASK) == 0) {
+                Cascade();
+            }
+
+            FireEntries(levels_[0][now_ & SLOT_MASK], on_expired);
+            FireEntries(expired_, on_expired);
+
+            if (generations_.empty()) {
+                Clear();
+                now_ = now;
+            }
+        }
+    }
+
+private:
+    static constexpr Time SLOT_MASK = SLOTS_COUNT - 1;
+
+    struct Entry {
+        Id id;
+        Time deadline;
+        std::uint64_t generation;
+    };
+
+    using Slot = std::vector<Entry>;
+    using Level = std::array<Slot, SLOTS_COUNT>;
+
+    bool IsActual(const Entry & entry) const {
+        auto it = generations_.find(entry.id);
+        return it != generations_.end() && it->second == entry.generation;
+    }
+
+    void Insert(Entry entry) {
+        if (entry.deadline <= now_) {
+            expired_.emplace_back(entry);
+            return;
+        }
+
+        Time delta = entry.deadline - now_;
+
+        for (size_t level = 0; level < LEVELS_COUNT; ++level) {
+            if (delta < (Time{1} << (SLOT_BITS * (level + 1)))) {
+                levels_[level][(entry.deadline >> (SLOT_BITS * level)) & SLOT_MASK].emplace_back(entry);
+                return;
+            }
+        }
+
+        overflow_.emplace_back(entry);
+    }
+
+    // Earliest time after now_ at which a non-empty slot is fired (level 0) or cascaded (upper levels).
+    // A slot at or before the current index of its level is reached in the next rotation of the level.
+    Time NextEventTime() const {
+        Time next = std::numeric_limits<Time>::max();
+
+        if (!overflow_.empty()) {
+            next = ((now_ >> (SLOT_BITS * LEVELS_COUNT)) + 1) << (SLOT_BITS * LEVELS_COUNT);
+        }
+
+        for (size_t level = 0; level < LEVELS_COUNT; ++level) {
+            unsigned shift = SLOT_BITS * level;
+            Time index = (now_ >> shift) & SLOT_MASK;
+            Time base = (now_ >> (shift + SLOT_BITS)) << (shift + SLOT_BITS);
+
+            for (Time step = 1; step <= SLOTS_COUNT; ++step) {
+                if (!levels_[level][(index + step) & SLOT_MASK].empty()) {
+                    next = std::min(next, base + ((index + step) << shift));
+                    break;
+                }
+            }
+        }
+
+        return next;
+    }
+
+    // Moves entries of the current upper level slots down to the lower levels
+    void Cascade() {
+        size_t top_level = 1;
+        while (top_level < LEVELS_COUNT - 1 && ((now_ >> (SLOT_BITS * top_level)) & SLOT_MASK) == 0) {
+            ++top_level;
+        }
+
+        if (top_level == LEVELS_COUNT - 1 && ((now_ >> (SLOT_BITS * top_level)) & SLOT_MASK) == 0) {
+            Reinsert(overflow_);
+        }
+
+        for (size_t level = top_level; level >= 1; --level) {
+            Reinsert(levels_[level][(now_ >> (SLOT_BITS * level)) & SLOT_MASK]);
+        }
+    }
+
+    void Reinsert(Slot & slot) {
+        Slot entries;
+        entries.swap(slot);
+
+        for (const Entry & entry : entries) {
+            if (IsActual(entry)) {
+                Insert(entry);
+            }
+        }
+    }
+
+    template <typename Fn>
+    void FireEntries(Slot & slot, Fn && on_expired) {
+        if (slot.empty()) {
+            return;
+        }
+
+        Slot entries;
+        entries.swap(slot);
+
+        for (const Entry & entry : entries) {
+            if (!IsActual(entry)) {
+                continue;
+            }
+
+            if (entry.deadline > now_) {
+                Insert(entry);
+                continue;
+            }
+
+            generations_.erase(entry.id);
+            on_expired(entry.id);
+        }
+    }
+
+    void Clear() {
+        for (Level & level : levels_) {
+            for (Slot & slot : level) {
+                slot.clear();
+            }
+        }
+
+        overflow_.clear();
+        expired_.clear();
+    }
+
+    Time now_;
+    std::uint64_t last_generation_ = 0;
+    std::unordered_map<Id, std::uint64_t> generations_;
+    std::array<Level, LEVELS_COUNT> levels_;
+    Slot overflow_;
+    Slot expired_;
+};
+
+} // namespace timer_wheel
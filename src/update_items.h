@@ -1,10 +1,10 @@
-#pragma once
-
-#include "collision_detector.h"
-#include "model.h"
-
-namespace collision_detector {
-
-void UpdateSessionItems(model::GameSession & session,  int interval);
-
+#pragma once
+
+#include "collision_detector.h"
+#include "model.h"
+
+namespace collision_detector {
+
+void UpdateSessionItems(model::GameSession & session,  int interval);
+
 } //namespace collision_detector
\ No newline at end of file
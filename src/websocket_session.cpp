@@ -0,0 +1,150 @@
+#include "websocket_session.h"
+
+#include <boost/asio/dispatch.hpp>
+
+#include "access_log.h"
+
+namespace http_server {
+
+namespace net = boost::asio;
+
+namespace {
+
+struct WebSocketMetrics {
+    static WebSocketMetrics & Instance() {
+        static WebSocketMetrics websocket_metrics;
+        return websocket_metrics;
+    }
+
+    metrics::Counter & sessions = metrics::Registry::Instance().GetCounter("ws_sessions_total");
+    metrics::Gauge & active_sessions = metrics::Registry::Instance().GetGauge("ws_sessions_active");
+    metrics::Counter & messages = metrics::Registry::Instance().GetCounter("ws_messages_received_total");
+    metrics::Counter & frames = metrics::Registry::Instance().GetCounter("ws_frames_sent_total");
+};
+
+} // namespace
+
+WebSocketSession::WebSocketSession(beast::tcp_stream && stream)
+    : ws_(std::move(stream))
+    , dropped_(metrics::Registry::Instance().GetCounter("ws_frames_dropped_total")) {
+    WebSocketMetrics::Instance().sessions.Increment();
+    WebSocketMetrics::Instance().active_sessions.Add();
+}
+
+WebSocketSession::~WebSocketSession() {
+    WebSocketMetrics::Instance().active_sessions.Sub();
+}
+
+//  *   The HTTP timeouts of the stream are replaced by the WebSocket ones: idle sockets are pinged
+void WebSocketSession::Run(http::request<http::string_body> && request, MessageHandler on_message) {
+    on_message_ = std::move(on_message);
+
+    beast::get_lowest_layer(ws_).expires_never();
+    ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+    ws_.read_message_max(MAX_MESSAGE_SIZE);
+
+    auto request_ptr = std::make_shared<http::request<http::string_body>>(std::move(request));
+
+    ws_.async_accept(*request_ptr, [self = shared_from_this(), request_ptr] (beast::error_code ec) {
+        self->OnAccept(ec);
+    });
+}
+
+void WebSocketSession::Send(Frame frame) {
+    net::dispatch(ws_.get_executor(), [self = shared_from_this(), frame = std::move(frame)] () mutable {
+        if (self->closed_) {
+            return;
+        }
+
+        if (self->pending_) {
+            self->dropped_.Increment();
+        }
+        self->pending_ = std::move(frame);
+
+        self->WritePending();
+    });
+}
+
+void WebSocketSession::Close() {
+    net::dispatch(ws_.get_executor(), [self = shared_from_this()] {
+        if (self->closed_) {
+            return;
+        }
+        self->closed_ = true;
+        self->pending_.reset();
+
+        if (!self->accepted_) {
+            return;
+        }
+
+        self->ws_.async_close(websocket::close_code::normal, [self] (beast::error_code) {});
+    });
+}
+
+void WebSocketSession::OnAccept(beast::error_code ec) {
+    if (ec) {
+        closed_ = true;
+        access_log::Logger::Instance().LogError(ec, "ws_accept");
+        return;
+    }
+
+    accepted_ = true;
+    ws_.text(true);
+
+    Read();
+    WritePending();
+}
+
+void WebSocketSession::Read() {
+    buf_.clear();
+    ws_.async_read(buf_, beast::bind_front_handler(&WebSocketSession::OnRead, shared_from_this()));
+}
+
+void WebSocketSession::OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read) {
+    if (ec) {
+        closed_ = true;
+        pending_.reset();
+
+        if (ec != websocket::error::closed) {
+            access_log::Logger::Instance().LogError(ec, "ws_read");
+        }
+        return;
+    }
+
+    WebSocketMetrics::Instance().messages.Increment();
+
+    if (ws_.got_text() && on_message_) {
+        auto data = buf_.cdata();
+        on_message_({static_cast<const char *>(data.data()), data.size()});
+    }
+
+    Read();
+}
+
+void WebSocketSession::WritePending() {
+    if (!accepted_ || closed_ || writing_ || !pending_) {
+        return;
+    }
+
+    writing_ = std::move(pending_);
+    pending_.reset();
+
+    ws_.async_write(net::buffer(*writing_), beast::bind_front_handler(&WebSocketSession::OnWrite, shared_from_this()));
+}
+
+void WebSocketSession::OnWrite(beast::error_code ec, [[maybe_unused]] std::size_t bytes_written) {
+    writing_.reset();
+
+    if (ec) {
+        closed_ = true;
+        pending_.reset();
+        access_log::Logger::Instance().LogError(ec, "ws_write");
+        return;
+    }
+
+    WebSocketMetrics::Instance().frames.Increment();
+
+    WritePending();
+}
+
+} // namespace http_server
@@ -0,0 +1,75 @@
+#ifndef BOOST_BEAST_USE_STD_STRING_VIEW
+#define BOOST_BEAST_USE_STD_STRING_VIEW
+#endif
+
+#pragma once
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "metrics.h"
+
+namespace http_server {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+
+/*
+ *  Server side of a WebSocket taken over from an HTTP session.
+ *
+ *  Frames are shared buffers: one serialized message may be sent to many sockets without copies.
+ *  A socket keeps at most one frame behind the write in progress, a newer frame replaces it,
+ *  so a slow client gets the latest state instead of a growing queue.
+ */
+class WebSocketSession : public std::enable_shared_from_this<WebSocketSession> {
+public:
+    using Frame = std::shared_ptr<const std::string>;
+    // Called on the socket executor for every text message
+    using MessageHandler = std::function<void(std::string_view message)>;
+
+    static constexpr size_t MAX_MESSAGE_SIZE = 4096;
+
+    explicit WebSocketSession(beast::tcp_stream && stream);
+
+    WebSocketSession(const WebSocketSession &) = delete;
+    WebSocketSession & operator=(const WebSocketSession &) = delete;
+
+    ~WebSocketSession();
+
+    // Answers the upgrade request and starts reading messages
+    void Run(http::request<http::string_body> && request, MessageHandler on_message);
+
+    // May be called from any thread
+    void Send(Frame frame);
+    void Close();
+
+private:
+    void OnAccept(beast::error_code ec);
+    void Read();
+    void OnRead(beast::error_code ec, std::size_t bytes_read);
+
+    void WritePending();
+    void OnWrite(beast::error_code ec, std::size_t bytes_written);
+
+    websocket::stream<beast::tcp_stream> ws_;
+    beast::flat_buffer buf_;
+    MessageHandler on_message_;
+
+//  *   Used on the stream strand only
+    Frame writing_;
+    Frame pending_;
+    bool accepted_ = false;
+    bool closed_ = false;
+
+    metrics::Counter & dropped_;
+};
+
+} // namespace http_server
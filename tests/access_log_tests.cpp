@@ -0,0 +1,113 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/asio/error.hpp>
+
+#include <string>
+#include <unistd.h>
+
+#include "../src/access_log.h"
+
+SCENARIO("Access log ring buffer") {
+    using access_log::Record;
+    using access_log::RingBuffer;
+
+    GIVEN("a ring buffer of four records") {
+        RingBuffer buffer{3};
+
+        auto record = [] (int code) {
+            Record record;
+            record.event = access_log::Event::RESPONSE;
+            record.code = code;
+            return record;
+        };
+
+        WHEN("it is filled") {
+            for (int code = 0; code < 4; ++code) {
+                REQUIRE(buffer.TryPush(record(code)));
+            }
+
+            THEN("the next record is rejected") {
+                CHECK_FALSE(buffer.TryPush(record(4)));
+            }
+
+            THEN("records are drained in order and free their slots") {
+                std::vector<int> codes;
+                CHECK(buffer.Drain([&codes] (const Record & r) { codes.emplace_back(r.code); }) == 4);
+                CHECK(codes == std::vector<int>{0, 1, 2, 3});
+
+                CHECK(buffer.TryPush(record(4)));
+                CHECK(buffer.Drain([] (const Record &) {}) == 1);
+            }
+        }
+    }
+
+    GIVEN("a long text") {
+        Record record;
+        record.SetText(std::string(1000, 'a'));
+
+        THEN("it is cut to the record size") {
+            CHECK(record.GetText() == std::string(Record::TEXT_SIZE, 'a'));
+        }
+    }
+
+    GIVEN("request URIs with a token in the query string") {
+        Record record;
+
+        THEN("the token value is masked and the rest is kept") {
+            record.SetUri("/api/v1/game/ws?token=0123456789abcdef0123456789abcdef");
+            CHECK(record.GetText() == "/api/v1/game/ws?token=***");
+
+            record.SetUri("/api/v1/game/ws?a=1&token=0123456789abcdef&tokens=2&b");
+            CHECK(record.GetText() == "/api/v1/game/ws?a=1&token=***&tokens=2&b");
+
+            record.SetUri("/api/v1/game/records?start=0&maxItems=10");
+            CHECK(record.GetText() == "/api/v1/game/records?start=0&maxItems=10");
+
+            record.SetUri("/index.html");
+            CHECK(record.GetText() == "/index.html");
+        }
+    }
+}
+
+SCENARIO("Asynchronous access log") {
+    using namespace std::literals;
+
+    access_log::Logger & logger = access_log::Logger::Instance();
+    metrics::Counter & dropped = metrics::Registry::Instance().GetCounter("log_records_dropped_total");
+
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+
+    GIVEN("a logger with a small buffer that is written on stop") {
+        logger.Start(access_log::Logger::Config{.fd = fds[1], .buffer_size = 2, .sample_rate = 2, .flush_interval = 1h});
+
+        WHEN("more records are logged than the buffer holds") {
+            std::uint64_t dropped_before = dropped.Get();
+
+            logger.LogRequest(boost::asio::ip::make_address("127.0.0.1"), "/api/v1/maps"sv, boost::beast::http::verb::get);
+            logger.LogResponse(200, 3ms, "application/json"sv);
+            logger.LogError(boost::asio::error::eof, "read");
+
+            logger.Stop();
+
+            THEN("the rest is dropped and counted") {
+                CHECK(dropped.Get() == dropped_before + 1);
+
+                std::string text(4096, '\0');
+                text.resize(read(fds[0], text.data(), text.size()));
+
+                CHECK(text.find("\"message\":\"request received\"") != std::string::npos);
+                CHECK(text.find("\"URI\":\"/api/v1/maps\"") != std::string::npos);
+                CHECK(text.find("\"message\":\"response sent\"") != std::string::npos);
+                CHECK(text.find("\"message\":\"error\"") == std::string::npos);
+            }
+
+            THEN("one of sample_rate requests is sampled") {
+                CHECK(logger.SampleRequest() != logger.SampleRequest());
+            }
+        }
+    }
+
+    close(fds[0]);
+    close(fds[1]);
+}
@@ -15,10 +15,89 @@ SCENARIO("Url decoding tests") {
     CHECK_THROWS_AS(http_utils::UrlDecode("I+love%20B%6F%6ST"sv), std::invalid_argument);
 }
 
+SCENARIO("Query parameter tests") {
+    using namespace std::literals;
+
+    CHECK(http_utils::GetQueryParam("/api/v1/game/ws?token=abc"sv, "token"sv) == "abc"sv);
+    CHECK(http_utils::GetQueryParam("/api/v1/game/records?start=0&maxItems=10"sv, "maxItems"sv) == "10"sv);
+    CHECK(http_utils::GetQueryParam("/path?flag&x=1"sv, "flag"sv) == ""sv);
+    CHECK_FALSE(http_utils::GetQueryParam("/path?tokens=1"sv, "token"sv));
+    CHECK_FALSE(http_utils::GetQueryParam("/path"sv, "token"sv));
+}
+
 SCENARIO("Token formatting tests") {
     using namespace std::literals;
 
     CHECK(http_utils::FormatToken("Bearer 00000000ffffffff00000000ffffffff\n\n"sv) == "00000000ffffffff00000000ffffffff"s);
     CHECK(http_utils::FormatToken("Bearer 00000000ffffffff00000000ffffffff"sv) == "00000000ffffffff00000000ffffffff"s);
     CHECK_THROWS_AS(http_utils::FormatToken("Bear 00000000"sv), std::invalid_argument);
-}
\ No newline at end of file
+}
+
+SCENARIO("Path normalization tests") {
+    using namespace std::literals;
+
+    auto normalize = [] (std::string path) {
+        return std::string{http_utils::NormalizePath(path)};
+    };
+
+    CHECK(normalize(""s) == "/"s);
+    CHECK(normalize("/"s) == "/"s);
+    CHECK(normalize("/api/v1/maps"s) == "/api/v1/maps"s);
+    CHECK(normalize("/api/v1/maps/"s) == "/api/v1/maps/"s);
+    CHECK(normalize("//api///v1/./maps"s) == "/api/v1/maps"s);
+    CHECK(normalize("/api/v1/game/../maps/map1"s) == "/api/v1/maps/map1"s);
+    CHECK(normalize("/static/.."s) == "/"s);
+    CHECK(normalize("/../../etc/passwd"s) == "/etc/passwd"s);
+    CHECK(normalize("/api/v1/game/records?start=0&maxItems=10"s) == "/api/v1/game/records"s);
+    CHECK(normalize("/static/../api/./v1/maps/?x=/../"s) == "/api/v1/maps/"s);
+}
+
+SCENARIO("Path matching tests") {
+    using namespace std::literals;
+
+    CHECK(http_utils::MatchPaths("/api/v1/maps"sv, "/api/v1/maps"sv));
+    CHECK(http_utils::MatchPaths("/api/v1/maps/"sv, "/api/v1/maps"sv));
+    CHECK(http_utils::MatchPaths("/api/v1/game/records?start=0"sv, "/api/v1/game/records"sv));
+    CHECK_FALSE(http_utils::MatchPaths("/api/v1/maps/map1"sv, "/api/v1/maps"sv));
+    CHECK_FALSE(http_utils::MatchPaths("/api/v1/mapsx"sv, "/api/v1/maps"sv));
+
+    CHECK(http_utils::PathBased("/api/v1/maps/map1"sv, "/api/v1/maps"sv) == 1);
+    CHECK(http_utils::PathBased("/api/v1/maps/map1/"sv, "/api/"sv) == 3);
+    CHECK(http_utils::PathBased("/api"sv, "/api/"sv) == 0);
+    CHECK(http_utils::PathBased("/index.html"sv, "/api/"sv) == -1);
+    CHECK(http_utils::PathBased("/ap"sv, "/api"sv) == -1);
+}
+
+SCENARIO("Conditional and range header tests") {
+    using namespace std::literals;
+
+    CHECK(http_utils::AcceptsEncoding("gzip, deflate, br"sv, "gzip"sv));
+    CHECK(http_utils::AcceptsEncoding("deflate;q=0.5, GZIP"sv, "gzip"sv));
+    CHECK(http_utils::AcceptsEncoding("*"sv, "deflate"sv));
+    CHECK_FALSE(http_utils::AcceptsEncoding(""sv, "gzip"sv));
+    CHECK_FALSE(http_utils::AcceptsEncoding("gzip;q=0"sv, "gzip"sv));
+    CHECK_FALSE(http_utils::AcceptsEncoding("*, gzip;q=0.0"sv, "gzip"sv));
+    CHECK_FALSE(http_utils::AcceptsEncoding("gzipx"sv, "gzip"sv));
+
+    CHECK(http_utils::MatchesEtag("\"abc\""sv, "\"abc\""sv));
+    CHECK(http_utils::MatchesEtag("\"x\", W/\"abc\""sv, "\"abc\""sv));
+    CHECK(http_utils::MatchesEtag("*"sv, "\"abc\""sv));
+    CHECK_FALSE(http_utils::MatchesEtag("\"abc-gzip\""sv, "\"abc\""sv));
+
+    auto range = [] (std::string_view value, std::uint64_t size) {
+        std::optional<http_utils::ByteRange> range = http_utils::ParseRange(value, size);
+        return range ? std::to_string(range->first) + "-" + std::to_string(range->last) + (range->satisfiable ? "" : "!") : "none"s;
+    };
+
+    CHECK(range("bytes=0-99"sv, 1000) == "0-99"s);
+    CHECK(range("bytes=500-"sv, 1000) == "500-999"s);
+    CHECK(range("bytes=900-2000"sv, 1000) == "900-999"s);
+    CHECK(range("bytes=-100"sv, 1000) == "900-999"s);
+    CHECK(range("bytes=-2000"sv, 1000) == "0-999"s);
+    CHECK(range("bytes=1000-"sv, 1000) == "0-0!"s);
+    CHECK(range("bytes=-0"sv, 1000) == "0-0!"s);
+    CHECK(range("bytes=5-1"sv, 1000) == "none"s);
+    CHECK(range("bytes=0-1,5-9"sv, 1000) == "none"s);
+    CHECK(range("items=0-1"sv, 1000) == "none"s);
+    CHECK(range("bytes=a-"sv, 1000) == "none"s);
+}
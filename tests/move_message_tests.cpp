@@ -0,0 +1,28 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/move_message.h"
+
+SCENARIO("WebSocket move messages") {
+    using http_handler::ParseMoveMessage;
+
+    GIVEN("a message with a direction") {
+        THEN("it is parsed into the direction of the move") {
+            CHECK(ParseMoveMessage(R"({"move": "L"})") == model::Direction::WEST);
+            CHECK(ParseMoveMessage(R"({"move": "R"})") == model::Direction::EAST);
+            CHECK(ParseMoveMessage(R"({"move": "U"})") == model::Direction::NORTH);
+            CHECK(ParseMoveMessage(R"({"move": "D"})") == model::Direction::SOUTH);
+            CHECK(ParseMoveMessage(R"({"move": ""})") == model::Direction::ZERO);
+        }
+    }
+
+    GIVEN("a malformed message") {
+        THEN("it is ignored") {
+            CHECK_FALSE(ParseMoveMessage(""));
+            CHECK_FALSE(ParseMoveMessage(R"({"move": "L")"));
+            CHECK_FALSE(ParseMoveMessage(R"(["L"])"));
+            CHECK_FALSE(ParseMoveMessage(R"({"direction": "L"})"));
+            CHECK_FALSE(ParseMoveMessage(R"({"move": 1})"));
+            CHECK_FALSE(ParseMoveMessage(R"({"move": "left"})"));
+        }
+    }
+}
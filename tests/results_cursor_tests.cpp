@@ -0,0 +1,51 @@
+#include "catch2/catch_test_macros.hpp"
+
+#include "../src/results_cursor.h"
+
+SCENARIO("Results cursor formatting") {
+    using namespace std::literals;
+
+    GIVEN("a cursor") {
+        app::ResultsCursor cursor{4294967295u, 0u, 42u, "Rex the dog"s};
+
+        WHEN("it is formatted and parsed back") {
+            std::string token = app::FormatResultsCursor(cursor);
+            app::ResultsCursor parsed = app::ParseResultsCursor(token);
+
+            THEN("the position is kept") {
+                CHECK(token == "ffffffff.0.2a.5265782074686520646f67"s);
+                CHECK(parsed.scores == cursor.scores);
+                CHECK(parsed.session_duration == cursor.session_duration);
+                CHECK(parsed.id == cursor.id);
+                CHECK(parsed.name == cursor.name);
+            }
+        }
+    }
+
+    GIVEN("a cursor with an empty name") {
+        app::ResultsCursor parsed = app::ParseResultsCursor(app::FormatResultsCursor({10u, 250u, 18446744073709551615u, ""s}));
+
+        CHECK(parsed.scores == 10u);
+        CHECK(parsed.session_duration == 250u);
+        CHECK(parsed.id == 18446744073709551615u);
+        CHECK(parsed.name.empty());
+    }
+
+    GIVEN("malformed tokens") {
+        CHECK_THROWS_AS(app::ParseResultsCursor(""sv), std::invalid_argument);
+        CHECK_THROWS_AS(app::ParseResultsCursor("10"sv), std::invalid_argument);
+        CHECK_THROWS_AS(app::ParseResultsCursor("10.20"sv), std::invalid_argument);
+        CHECK_THROWS_AS(app::ParseResultsCursor(".20.41"sv), std::invalid_argument);
+        CHECK_THROWS_AS(app::ParseResultsCursor("10.20.4"sv), std::invalid_argument);
+        CHECK_THROWS_AS(app::ParseResultsCursor("10.20.41"sv), std::invalid_argument);
+        CHECK_THROWS_AS(app::ParseResultsCursor("10.20..41"sv), std::invalid_argument);
+        CHECK_THROWS_AS(app::ParseResultsCursor("10.20.1.4"sv), std::invalid_argument);
+        CHECK_THROWS_AS(app::ParseResultsCursor("10.20.4g"sv), std::invalid_argument);
+        CHECK_THROWS_AS(app::ParseResultsCursor("1x.20.41"sv), std::invalid_argument);
+        CHECK_THROWS_AS(app::ParseResultsCursor("100000000.20.41"sv), std::invalid_argument);
+        CHECK_THROWS_AS(app::ParseResultsCursor("10.20.1.4g"sv), std::invalid_argument);
+        CHECK_THROWS_AS(app::ParseResultsCursor("1x.20.1.41"sv), std::invalid_argument);
+        CHECK_THROWS_AS(app::ParseResultsCursor("100000000.20.1.41"sv), std::invalid_argument);
+        CHECK_THROWS_AS(app::ParseResultsCursor("10.20.10000000000000000.41"sv), std::invalid_argument);
+    }
+}
@@ -0,0 +1,135 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "../src/results_store.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+void AppendBytes(const fs::path & path, const std::string & bytes) {
+    std::ofstream{path, std::ios::binary | std::ios::app} << bytes;
+}
+
+std::string RecordHeader(std::uint64_t id, std::uint32_t scores, std::uint32_t session_duration, std::uint32_t name_size) {
+    std::string header;
+    header.append(reinterpret_cast<const char *>(&id), sizeof(id));
+    header.append(reinterpret_cast<const char *>(&scores), sizeof(scores));
+    header.append(reinterpret_cast<const char *>(&session_duration), sizeof(session_duration));
+    header.append(reinterpret_cast<const char *>(&name_size), sizeof(name_size));
+
+    return header;
+}
+
+} // namespace
+
+SCENARIO("Local results store") {
+    using namespace std::literals;
+
+    fs::path dir = fs::temp_directory_path() / "results_store_tests";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    fs::path path = dir / "results";
+
+    GIVEN("results appended in two batches") {
+        {
+            results_store::LocalResultsStore store{path};
+            store.Append({{"Rex"sv, 10, 100, 1}, {"Bim"sv, 30, 200, 2}});
+            store.Append({{"Tuzik"sv, 10, 100, 3}, {"Rex"sv, 10, 100, 4}});
+
+            CHECK(store.Size() == 4);
+            CHECK(store.GetLastResultId() == 4);
+        }
+
+        WHEN("the store is opened again") {
+            results_store::LocalResultsStore store{path};
+
+            THEN("every result is read back in the records order") {
+                std::vector<app::GameResult> results = store.GetResults(10, 0);
+
+                REQUIRE(results.size() == 4);
+                CHECK(results[0].name_ == "Bim"s);
+                CHECK(results[1].name_ == "Rex"s);
+                CHECK(results[1].id_ == 1);
+                CHECK(results[2].name_ == "Rex"s);
+                CHECK(results[2].id_ == 4);
+                CHECK(results[3].name_ == "Tuzik"s);
+                CHECK(results[3].scores_ == 10);
+                CHECK(results[3].session_duration_ == 100);
+
+                CHECK(store.GetLastResultId() == 4);
+            }
+
+            THEN("a cursor on a tied result continues with the next one") {
+                std::vector<app::GameResult> results = store.GetResultsAfter({10, 100, 1, "Rex"s}, 10);
+
+                REQUIRE(results.size() == 2);
+                CHECK(results[0].id_ == 4);
+                CHECK(results[1].id_ == 3);
+            }
+        }
+    }
+
+    GIVEN("a result ranked below the one appended after it") {
+        results_store::LocalResultsStore store{path};
+        store.Append({{"Rex"sv, 10, 100, 1}});
+        store.Append({{"Bim"sv, 30, 200, 2}});
+
+        THEN("the last result id is the id appended last") {
+            CHECK(store.GetLastResultId() == 2);
+        }
+    }
+
+    GIVEN("a log with a torn record at its end") {
+        {
+            results_store::LocalResultsStore store{path};
+            store.Append({{"Rex"sv, 10, 100, 1}});
+        }
+        std::uintmax_t valid_size = fs::file_size(path);
+
+        AppendBytes(path, RecordHeader(2, 20, 200, 5) + "Tu"s);
+
+        WHEN("the store is opened") {
+            results_store::LocalResultsStore store{path};
+
+            THEN("the torn record is cut off") {
+                CHECK(store.Size() == 1);
+                CHECK(fs::file_size(path) == valid_size);
+            }
+
+            AND_WHEN("more results are appended") {
+                store.Append({{"Bim"sv, 30, 300, 3}});
+
+                THEN("they are read after the last complete record") {
+                    results_store::LocalResultsStore reopened{path};
+
+                    REQUIRE(reopened.Size() == 2);
+                    CHECK(reopened.GetResults(10, 0)[0].name_ == "Bim"s);
+                    CHECK(reopened.GetLastResultId() == 3);
+                }
+            }
+        }
+    }
+
+    GIVEN("a record with a name length past the end of the file") {
+        {
+            results_store::LocalResultsStore store{path};
+            store.Append({{"Rex"sv, 10, 100, 1}});
+        }
+        std::uintmax_t valid_size = fs::file_size(path);
+
+        AppendBytes(path, RecordHeader(2, 20, 200, 0xffffffffu) + "Tuzik"s);
+
+        THEN("the record is dropped without reading the name") {
+            results_store::LocalResultsStore store{path};
+
+            CHECK(store.Size() == 1);
+            CHECK(fs::file_size(path) == valid_size);
+        }
+    }
+
+    fs::remove_all(dir);
+}
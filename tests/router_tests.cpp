@@ -0,0 +1,74 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/router.h"
+
+SCENARIO("Compiled router") {
+    enum class Route {
+        MAPS,
+        MAPS_HEAD,
+        MAP,
+        JOIN,
+        API
+    };
+
+    using Router = router::Router<Route>;
+    using boost::beast::http::verb;
+
+    GIVEN("a router with literal, parameter and prefix routes") {
+        Router router;
+        router.Add("/api/v1/maps", verb::get, Route::MAPS);
+        router.Add("/api/v1/maps", verb::head, Route::MAPS_HEAD);
+        router.Add("/api/v1/maps/{map_id}", verb::get, Route::MAP);
+        router.Add("/api/v1/game/join", verb::post, Route::JOIN);
+        router.Add("/api/*", verb::get, Route::API);
+
+        THEN("literal paths are matched by method") {
+            Router::Match match = router.Find("/api/v1/maps", verb::get);
+            CHECK(match.status == Router::Status::FOUND);
+            CHECK(match.route == Route::MAPS);
+
+            match = router.Find("/api/v1/maps", verb::head);
+            CHECK(match.status == Router::Status::FOUND);
+            CHECK(match.route == Route::MAPS_HEAD);
+        }
+
+        THEN("parameters are captured") {
+            Router::Match match = router.Find("/api/v1/maps/map1", verb::get);
+            REQUIRE(match.status == Router::Status::FOUND);
+            CHECK(match.route == Route::MAP);
+            REQUIRE(match.params_count == 1);
+            CHECK(match.params[0] == "map1");
+        }
+
+        THEN("other methods get 405 with the registered ones") {
+            Router::Match match = router.Find("/api/v1/maps", verb::post);
+            CHECK(match.status == Router::Status::METHOD_NOT_ALLOWED);
+            CHECK(match.allow == "GET, HEAD");
+
+            match = router.Find("/api/v1/game/join", verb::get);
+            CHECK(match.status == Router::Status::METHOD_NOT_ALLOWED);
+            CHECK(match.allow == "POST");
+        }
+
+        THEN("unknown paths fall back to the prefix route") {
+            Router::Match match = router.Find("/api/v1/maps/map1/extra", verb::get);
+            CHECK(match.status == Router::Status::FOUND);
+            CHECK(match.route == Route::API);
+            CHECK(match.params_count == 0);
+
+            CHECK(router.Find("/api/v1/maps/", verb::get).route == Route::API);
+            CHECK(router.Find("/api", verb::get).route == Route::API);
+            CHECK(router.Find("/api/unknown", verb::post).status == Router::Status::NOT_FOUND);
+        }
+
+        THEN("paths outside of the routes are not found") {
+            CHECK(router.Find("/", verb::get).status == Router::Status::NOT_FOUND);
+            CHECK(router.Find("/index.html", verb::get).status == Router::Status::NOT_FOUND);
+            CHECK(router.Find("/apix", verb::get).status == Router::Status::NOT_FOUND);
+        }
+
+        THEN("a route can't be registered twice") {
+            CHECK_THROWS_AS(router.Add("/api/v1/maps", verb::get, Route::MAPS), std::invalid_argument);
+        }
+    }
+}
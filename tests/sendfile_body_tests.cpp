@@ -0,0 +1,77 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/beast/http.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "../src/sendfile_body.h"
+
+SCENARIO("Sendfile body") {
+    namespace fs = std::filesystem;
+    namespace http = boost::beast::http;
+    using namespace std::literals;
+
+    fs::path path = fs::temp_directory_path() / "sendfile_body_tests.txt";
+    std::ofstream{path, std::ios::binary} << "0123456789abcdef";
+
+    GIVEN("an opened file") {
+        http::response<http_server::SendfileBody> response{http::status::ok, 11};
+
+        boost::beast::error_code ec;
+        response.body().Open(path.c_str(), ec);
+        REQUIRE_FALSE(ec);
+
+        THEN("the whole file is the body") {
+            CHECK(response.body().GetOffset() == 0);
+            CHECK(response.body().GetSize() == 16);
+        }
+
+        WHEN("a range is set") {
+            response.body().SetRange(4, 6);
+            response.prepare_payload();
+
+            THEN("only the range is sent") {
+                CHECK(response.payload_size().value_or(0) == 6);
+
+                std::ostringstream out;
+                out << response;
+                CHECK(out.str().ends_with("\r\n\r\n456789"s));
+            }
+
+            THEN("sent bytes are consumed") {
+                response.body().Consume(4);
+                CHECK(response.body().GetOffset() == 8);
+                CHECK(response.body().GetSize() == 2);
+
+                response.body().Consume(10);
+                CHECK(response.body().GetSize() == 0);
+            }
+        }
+
+        WHEN("the range goes past the end") {
+            response.body().SetRange(10, 100);
+
+            THEN("it is cut at the end of the file") {
+                CHECK(response.body().GetOffset() == 10);
+                CHECK(response.body().GetSize() == 6);
+            }
+        }
+    }
+
+    GIVEN("a missing file") {
+        http_server::SendfileBody::value_type body;
+
+        boost::beast::error_code ec;
+        body.Open((path.string() + ".missing").c_str(), ec);
+
+        THEN("it is not opened") {
+            CHECK(ec);
+            CHECK_FALSE(body.IsOpen());
+        }
+    }
+
+    fs::remove(path);
+}
@@ -1,65 +1,458 @@
-#include <catch2/catch_test_macros.hpp>
-#include <catch2/matchers/catch_matchers_vector.hpp>
-#include <boost/archive/polymorphic_text_oarchive.hpp>
-#include <boost/archive/polymorphic_text_iarchive.hpp>
-
-#include <filesystem>
-#include <sstream>
-
-#include "../src/save_manager.h"
-#include "../src/serializer.h"
-#include "../src/model.h"
-#include "../src/app.h"
-#include "../src/json_loader.h"
-
-namespace fs = std::filesystem;
-using namespace Catch::Matchers;
-
-static constexpr char AUTOSAVE_FILE_PATH[] = "saved_data";
-
-SCENARIO("Test serialization") {
-    GIVEN("Game object with one session and player is added by PlayerManager") {
-        fs::path config_file_path{"config.json"};
-        model::Game game = json_loader::LoadGame(config_file_path);
-
-        auto session = game.NewSession(const_cast<model::Map *>(game.FindMap(model::Map::Id{"town"})));
-
-        app::PlayersManager::Instance().AddNewPlayer("Test", session);
-
-        WHEN("Init GameSerializationProvider object") {
-            serializer::GameSerializationProvider game_provider(game);
-            serializer::PlayersManagerSerializationProvider players_manager_provider(app::PlayersManager::Instance());
-
-            WHEN ("Try serialize it") {
-                std::stringstream ss;
-
-                boost::archive::polymorphic_text_oarchive oa{ss};
-                oa << game_provider << players_manager_provider;
-
-                AND_THEN("Try save serialized game object") {
-                    save_manager::SaveToFile(AUTOSAVE_FILE_PATH, ss.str());
-
-                    REQUIRE(fs::is_regular_file(AUTOSAVE_FILE_PATH));
-                }
-            }
-        }
-
-    }
-
-    GIVEN("Autosave file") {
-        WHEN("Try load saved data from file") {
-            std::stringstream ss(save_manager::LoadSavedFile(AUTOSAVE_FILE_PATH));
-            boost::archive::polymorphic_text_iarchive ia(ss);
-
-            AND_THEN("Parse data and insert it into object") {
-                serializer::GameSerializationProvider game_provider;
-                serializer::PlayersManagerSerializationProvider players_manager_provider;
-
-                ia >> game_provider >> players_manager_provider;
-
-                CHECK(game_provider.sessions_providers.size() == 1);
-                CHECK(players_manager_provider.players_providers.size() == 1);
-            }
-        }
-    }
-}
\ No newline at end of file
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_vector.hpp>
+#include <boost/archive/polymorphic_text_oarchive.hpp>
+#include <boost/archive/polymorphic_text_iarchive.hpp>
+
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <sstream>
+#include <thread>
+
+#include <sys/resource.h>
+
+#include "../src/save_manager.h"
+#include "../src/serializer.h"
+#include "../src/snapshot.h"
+#include "../src/journal.h"
+#include "../src/model.h"
+#include "../src/app.h"
+#include "../src/json_loader.h"
+
+namespace fs = std::filesystem;
+using namespace Catch::Matchers;
+
+static constexpr char AUTOSAVE_FILE_PATH[] = "saved_data";
+
+SCENARIO("Test serialization") {
+    GIVEN("Game object with one session and player is added by PlayerManager") {
+        fs::path config_file_path{"config.json"};
+        model::Game game = json_loader::LoadGame(config_file_path);
+
+        auto session = game.NewSession(const_cast<model::Map *>(game.FindMap(model::Map::Id{"town"})));
+
+        app::PlayersManager::Instance().AddNewPlayer("Test", session);
+
+        WHEN("Init GameSerializationProvider object") {
+            serializer::GameSerializationProvider game_provider(game);
+            serializer::PlayersManagerSerializationProvider players_manager_provider(app::PlayersManager::Instance());
+
+            WHEN ("Try serialize it") {
+                std::stringstream ss;
+
+                boost::archive::polymorphic_text_oarchive oa{ss};
+                oa << game_provider << players_manager_provider;
+
+                AND_THEN("Try save serialized game object") {
+                    save_manager::SaveToFile(AUTOSAVE_FILE_PATH, ss.str());
+
+                    REQUIRE(fs::is_regular_file(AUTOSAVE_FILE_PATH));
+                }
+            }
+        }
+
+    }
+
+    GIVEN("Autosave file") {
+        WHEN("Try load saved data from file") {
+            std::stringstream ss(save_manager::LoadSavedFile(AUTOSAVE_FILE_PATH));
+            boost::archive::polymorphic_text_iarchive ia(ss);
+
+            AND_THEN("Parse data and insert it into object") {
+                serializer::GameSerializationProvider game_provider;
+                serializer::PlayersManagerSerializationProvider players_manager_provider;
+
+                ia >> game_provider >> players_manager_provider;
+
+                CHECK(game_provider.sessions_providers.size() == 1);
+                CHECK(players_manager_provider.players_providers.size() == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("Test binary snapshot") {
+    GIVEN("Game object with one session and a dog holding an item") {
+        fs::path config_file_path{"config.json"};
+        model::Game game = json_loader::LoadGame(config_file_path);
+
+        model::Map * map = const_cast<model::Map *>(game.FindMap(model::Map::Id{"town"}));
+        auto session = game.NewSession(map);
+
+        auto player = app::PlayersManager::Instance().AddNewPlayer("Snapshot", session);
+        player->AddScores(42);
+
+        model::Dog * dog = session->GetDogById(player->GetPlayerId());
+        dog->SetPosition(model::Vector2{1.25, 3.5});
+        dog->SetSpeed(model::Vector2{0, 2.5});
+        dog->AddItem(model::Item(7, map->GetItemsTypes().front(), model::Point{1, 3}));
+
+        session->AddItems(3);
+
+        WHEN("It is written as a snapshot") {
+            std::string data = snapshot::SerializeGame(game);
+
+            THEN("The snapshot is recognized") {
+                CHECK(snapshot::IsSnapshot(data));
+                CHECK_FALSE(snapshot::IsSnapshot("22 serialization::archive"));
+            }
+
+            AND_WHEN("It is read into another game") {
+                model::Game restored_game = json_loader::LoadGame(config_file_path);
+                snapshot::Checkpoint checkpoint = snapshot::DeserializeGame(data, restored_game);
+
+                THEN("Sessions, dogs, items and players are restored") {
+                    CHECK(checkpoint.journal_sequence == 0);
+
+                    REQUIRE(restored_game.GetSessions().size() == 1);
+
+                    model::GameSession & restored_session = restored_game.GetSessions().front();
+                    CHECK(*restored_session.GetMap()->GetId() == "town");
+                    CHECK(restored_session.GetDogs().size() == session->GetDogs().size());
+                    CHECK(restored_session.GetItems().size() == session->GetItems().size());
+
+                    model::Dog * restored_dog = restored_session.GetDogById(player->GetPlayerId());
+                    REQUIRE(restored_dog != nullptr);
+                    CHECK(restored_dog->GetPosition() == model::Vector2{1.25, 3.5});
+                    CHECK(restored_dog->GetSpeed() == model::Vector2{0, 2.5});
+                    REQUIRE(restored_dog->GetItems().size() == 1);
+                    CHECK(restored_dog->GetItems().front().GetId() == 7);
+
+                    auto restored_player = app::PlayersManager::Instance().GetPlayerByToken(player->GetToken());
+                    REQUIRE(restored_player != nullptr);
+                    CHECK(restored_player->GetPlayerName() == "Snapshot");
+                    CHECK(restored_player->GetScores() == 42);
+                }
+            }
+
+            AND_WHEN("It is saved and mapped back") {
+                save_manager::SaveToFile(AUTOSAVE_FILE_PATH, data);
+                save_manager::MappedFile save_file(AUTOSAVE_FILE_PATH);
+
+                THEN("The mapped data is the snapshot") {
+                    CHECK(save_file.Data() == data);
+                }
+            }
+
+            AND_WHEN("It is damaged") {
+                model::Game restored_game = json_loader::LoadGame(config_file_path);
+
+                THEN("Reading it fails") {
+                    std::string corrupted = data;
+                    corrupted.back() ^= 0x1;
+                    CHECK_THROWS_AS(snapshot::DeserializeGame(corrupted, restored_game), std::invalid_argument);
+
+                    std::string truncated = data.substr(0, data.size() - 1);
+                    CHECK_THROWS_AS(snapshot::DeserializeGame(truncated, restored_game), std::invalid_argument);
+                }
+            }
+        }
+
+        WHEN("It is written with the game clock, the journal position and the loot generator time") {
+            snapshot::GameState state = snapshot::CaptureGame(game);
+            state.game_time = 12000;
+            state.journal_sequence = 17;
+            state.time_without_loot = 3500;
+
+            std::string data = snapshot::SerializeState(state);
+
+            THEN("They are read back as the checkpoint") {
+                model::Game restored_game = json_loader::LoadGame(config_file_path);
+                snapshot::Checkpoint checkpoint = snapshot::DeserializeGame(data, restored_game);
+
+                CHECK(checkpoint.game_time == std::chrono::milliseconds{12000});
+                CHECK(checkpoint.journal_sequence == 17);
+                CHECK(checkpoint.time_without_loot == std::chrono::milliseconds{3500});
+            }
+        }
+    }
+}
+
+SCENARIO("Test autosave scheduler") {
+    using namespace std::chrono_literals;
+    using Clock = save_manager::SaveScheduler::Clock;
+
+    GIVEN("A scheduler with a one second period and a threshold of ten changes") {
+        Clock::time_point start{};
+        int saves = 0;
+
+        save_manager::SaveScheduler scheduler{save_manager::SaveScheduler::Config{.period = 1000ms, .dirty_threshold = 10}, [&saves] {
+            ++saves;
+        }, start};
+
+        WHEN("Ticks come before the deadline") {
+            scheduler.Poll(1, start + 500ms);
+            scheduler.Poll(2, start + 999ms);
+
+            THEN("Nothing is saved") {
+                CHECK(saves == 0);
+            }
+        }
+
+        WHEN("The deadline passes") {
+            scheduler.Poll(1, start + 1010ms);
+
+            THEN("One save starts and it is in flight until finished") {
+                CHECK(saves == 1);
+                CHECK(scheduler.IsInFlight());
+
+                AND_WHEN("The next deadline passes before it finishes") {
+                    scheduler.Poll(2, start + 2010ms);
+
+                    THEN("That save is skipped") {
+                        CHECK(saves == 1);
+                    }
+                }
+
+                AND_WHEN("It finishes before the next deadline") {
+                    scheduler.Finish();
+                    scheduler.Poll(2, start + 1500ms);
+                    scheduler.Poll(3, start + 2001ms);
+
+                    THEN("The next save starts on the period grid") {
+                        CHECK(saves == 2);
+                    }
+                }
+            }
+        }
+
+        WHEN("Enough changes pile up before the deadline") {
+            scheduler.Poll(10, start + 100ms);
+
+            THEN("The state is saved early") {
+                CHECK(saves == 1);
+            }
+        }
+    }
+}
+
+SCENARIO("Test snapshot writer") {
+    GIVEN("A writer keeping two compressed generations") {
+        fs::path dir = fs::temp_directory_path() / "snapshot_writer_tests";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        std::string path = (dir / "state").string();
+
+        save_manager::SnapshotWriter writer{save_manager::SnapshotWriter::Config{.path = path, .compress = true, .generations = 2}};
+
+        WHEN("Three saves are written") {
+            for (char c : {'a', 'b', 'c'}) {
+                writer.Save([c] {
+                    return std::string(4096, c);
+                });
+            }
+
+            THEN("The last two are kept, compressed, and no temporary file is left") {
+                std::vector<std::string> paths = save_manager::GetGenerationPaths(path, 2);
+                REQUIRE(paths.size() == 2);
+
+                save_manager::MappedFile newest(paths[0]);
+                REQUIRE(save_manager::IsCompressed(newest.Data()));
+                CHECK(save_manager::Decompress(newest.Data()) == std::string(4096, 'c'));
+
+                save_manager::MappedFile previous(paths[1]);
+                CHECK(save_manager::Decompress(previous.Data()) == std::string(4096, 'b'));
+
+                CHECK_FALSE(fs::exists(path + "_temp"));
+                CHECK_FALSE(fs::exists(path + ".2"));
+            }
+        }
+    }
+}
+
+SCENARIO("Test action journal") {
+    GIVEN("A journal with one record of every type") {
+        fs::path dir = fs::temp_directory_path() / "journal_tests";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        std::string path = (dir / "journal").string();
+
+        app::Token token = app::ParseToken("0123456789abcdef0123456789abcdef");
+
+        {
+            journal::Journal journal{journal::Journal::Config{.path = path}};
+            journal.Recover(0, [] (const journal::Record &) {
+                FAIL("A new journal has no records");
+            });
+
+            journal.Append(journal::JoinRecord{1, token, "Journal", "town", 1.5, 2.0, 100});
+            journal.Append(journal::MoveRecord{1, model::Direction::EAST});
+            journal.Append(journal::TickRecord{50, 42});
+            journal.Append(journal::RetireRecord{1});
+        }
+
+        std::vector<journal::Record> records;
+        auto collect = [&records] (const journal::Record & record) {
+            records.push_back(record);
+        };
+
+        WHEN("It is recovered without a checkpoint") {
+            journal::Journal journal{journal::Journal::Config{.path = path}};
+            journal.Recover(0, collect);
+
+            THEN("Every record is replayed in order") {
+                REQUIRE(records.size() == 4);
+
+                const auto & join = std::get<journal::JoinRecord>(records[0]);
+                CHECK(join.player_id == 1);
+                CHECK(join.token == token);
+                CHECK(join.name == "Journal");
+                CHECK(join.map_id == "town");
+                CHECK(join.x == 1.5);
+                CHECK(join.join_time == 100);
+
+                CHECK(std::get<journal::MoveRecord>(records[1]).direction == model::Direction::EAST);
+                CHECK(std::get<journal::TickRecord>(records[2]).delta == 50);
+                CHECK(std::get<journal::TickRecord>(records[2]).seed == 42);
+                CHECK(std::get<journal::RetireRecord>(records[3]).player_id == 1);
+            }
+        }
+
+        WHEN("A checkpoint covers the first two records") {
+            journal::Journal journal{journal::Journal::Config{.path = path}};
+            journal.Recover(2, collect);
+
+            THEN("Only the records after it are replayed") {
+                REQUIRE(records.size() == 2);
+                CHECK(std::holds_alternative<journal::TickRecord>(records[0]));
+                CHECK(journal.BeginCheckpoint() == 4);
+            }
+        }
+
+        WHEN("The last write was torn") {
+            fs::path segment = path + ".1";
+            fs::resize_file(segment, fs::file_size(segment) - 1);
+
+            journal::Journal journal{journal::Journal::Config{.path = path}};
+            journal.Recover(0, collect);
+
+            THEN("The records before it are replayed") {
+                CHECK(records.size() == 3);
+            }
+        }
+    }
+
+    GIVEN("A journal whose writes fail for a while") {
+        using namespace std::chrono_literals;
+
+        fs::path dir = fs::temp_directory_path() / "journal_tests";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        std::string path = (dir / "journal").string();
+
+        metrics::Counter & failures = metrics::Registry::Instance().GetCounter("journal_write_failures_total");
+        std::uint64_t failures_before = failures.Get();
+
+//  *   Files can't grow past a few bytes: the first write is cut in the middle of a record, the next ones fail with EFBIG
+        std::signal(SIGXFSZ, SIG_IGN);
+        rlimit limit{};
+        getrlimit(RLIMIT_FSIZE, &limit);
+        rlimit small_limit = limit;
+        small_limit.rlim_cur = 40;
+
+        {
+            journal::Journal journal{journal::Journal::Config{.path = path, .commit_interval = 1ms, .retry_interval = 10ms}};
+            journal.Recover(0, [] (const journal::Record &) {});
+
+            setrlimit(RLIMIT_FSIZE, &small_limit);
+
+            journal.Append(journal::JoinRecord{1, app::ParseToken("0123456789abcdef0123456789abcdef"), "Journal", "town", 1.5, 2.0, 100});
+            journal.Append(journal::MoveRecord{1, model::Direction::EAST});
+
+            for (int i = 0; i < 500 && failures.Get() == failures_before; ++i) {
+                std::this_thread::sleep_for(10ms);
+            }
+
+            setrlimit(RLIMIT_FSIZE, &limit);
+
+            journal.Append(journal::TickRecord{50, 42});
+        }
+
+        WHEN("It is recovered after the writes succeed again") {
+            std::vector<journal::Record> records;
+            journal::Journal journal{journal::Journal::Config{.path = path}};
+            journal.Recover(0, [&records] (const journal::Record & record) {
+                records.push_back(record);
+            });
+
+            THEN("The failed records were written again without a gap") {
+                CHECK(failures.Get() > failures_before);
+
+                REQUIRE(records.size() == 3);
+                CHECK(std::holds_alternative<journal::JoinRecord>(records[0]));
+                CHECK(std::holds_alternative<journal::MoveRecord>(records[1]));
+                CHECK(std::holds_alternative<journal::TickRecord>(records[2]));
+            }
+        }
+
+        fs::remove_all(dir);
+    }
+
+    GIVEN("A disabled journal") {
+        journal::Journal journal{journal::Journal::Config{}};
+        journal.Recover(0, [] (const journal::Record &) {});
+
+        WHEN("Ticks, a join, a move and a retirement are appended") {
+            journal.Append(journal::TickRecord{50, 1});
+            journal.Append(journal::JoinRecord{1, app::ParseToken("0123456789abcdef0123456789abcdef"), "Journal", "town", 0, 0, 0});
+            journal.Append(journal::TickRecord{50, 2});
+            journal.Append(journal::MoveRecord{1, model::Direction::EAST});
+            journal.Append(journal::RetireRecord{1});
+
+            THEN("Only the player inputs are counted as changes") {
+                CHECK(journal.GetInputCount() == 2);
+                CHECK(journal.BeginCheckpoint() == 0);
+            }
+        }
+    }
+
+    GIVEN("A record after each of two written checkpoints") {
+        fs::path dir = fs::temp_directory_path() / "journal_tests";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        std::string path = (dir / "journal").string();
+
+        app::Token token = app::ParseToken("0123456789abcdef0123456789abcdef");
+
+        auto write = [&path, &token] (unsigned keep_checkpoints) {
+            journal::Journal journal{journal::Journal::Config{.path = path, .keep_checkpoints = keep_checkpoints}};
+            journal.Recover(0, [] (const journal::Record &) {});
+
+            journal.Append(journal::JoinRecord{1, token, "Journal", "town", 1.5, 2.0, 100});
+            journal.CompleteCheckpoint(journal.BeginCheckpoint());
+            journal.Append(journal::MoveRecord{1, model::Direction::EAST});
+            journal.CompleteCheckpoint(journal.BeginCheckpoint());
+            journal.Append(journal::TickRecord{50, 42});
+        };
+
+        std::vector<journal::Record> records;
+        auto collect = [&records] (const journal::Record & record) {
+            records.push_back(record);
+        };
+
+        WHEN("Segments are kept for two checkpoints") {
+            write(2);
+
+            THEN("The older checkpoint is replayed up to the last record") {
+                journal::Journal journal{journal::Journal::Config{.path = path, .keep_checkpoints = 2}};
+                journal.Recover(1, collect);
+
+                REQUIRE(records.size() == 2);
+                CHECK(std::holds_alternative<journal::MoveRecord>(records[0]));
+                CHECK(std::holds_alternative<journal::TickRecord>(records[1]));
+            }
+        }
+
+        WHEN("Segments are kept for the last checkpoint only") {
+            write(1);
+
+            THEN("Replaying the older checkpoint reports the missing records") {
+                journal::Journal journal{journal::Journal::Config{.path = path}};
+                CHECK_THROWS_AS(journal.Recover(1, collect), std::runtime_error);
+                CHECK(records.empty());
+            }
+        }
+
+        fs::remove_all(dir);
+    }
+}
@@ -0,0 +1,100 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/asio/io_context.hpp>
+
+#include <memory>
+#include <string>
+
+#include "../src/state_publisher.h"
+#include "../src/app.h"
+
+SCENARIO("WebSocket state publisher") {
+    namespace net = boost::asio;
+    using http_server::WebSocketSession;
+
+    metrics::Registry & registry = metrics::Registry::Instance();
+    metrics::Counter & serialized = registry.GetCounter("ws_states_serialized_total");
+    metrics::Gauge & subscribers = registry.GetGauge("ws_subscribers");
+    metrics::Counter & dropped = registry.GetCounter("ws_frames_dropped_total");
+
+    GIVEN("a game session with a player and a socket that is not accepted yet") {
+        model::Game game;
+        model::Map map{model::Map::Id{"town"}, "Town"};
+        map.AddRoad(model::Road{model::Road::HORIZONTAL, model::Point{0, 0}, 10});
+        game.AddMap(map);
+
+        model::GameSession * session = game.NewSession(const_cast<model::Map *>(game.FindMap(model::Map::Id{"town"})));
+        std::shared_ptr<app::Player> player = app::PlayersManager::Instance().AddNewPlayer("Publisher", session);
+
+        net::io_context ioc;
+        auto socket = std::make_shared<WebSocketSession>(boost::beast::tcp_stream{ioc});
+
+        http_handler::StatePublisher publisher;
+
+//  *   Frames of a socket that is not accepted wait in its single pending slot, a newer one replaces it
+        auto send_two_frames = [&socket, &ioc] {
+            auto frame = std::make_shared<const std::string>("{}");
+            socket->Send(frame);
+            socket->Send(frame);
+            ioc.restart();
+            ioc.run();
+        };
+
+        std::uint64_t serialized_before = serialized.Get();
+        std::int64_t subscribers_before = subscribers.Get();
+
+        WHEN("a player that is not in the game subscribes") {
+            bool subscribed = publisher.Subscribe(player->GetPlayerId() + 1000, socket);
+
+            THEN("the socket is refused") {
+                CHECK_FALSE(subscribed);
+                CHECK(subscribers.Get() == subscribers_before);
+            }
+        }
+
+        WHEN("the player subscribes") {
+            REQUIRE(publisher.Subscribe(player->GetPlayerId(), socket));
+            CHECK(subscribers.Get() == subscribers_before + 1);
+
+            AND_WHEN("the state is published twice") {
+                std::uint64_t dropped_before = dropped.Get();
+
+                publisher.Publish(game);
+                publisher.Publish(game);
+                ioc.run();
+
+                THEN("every state is serialized once and sent to the socket") {
+                    CHECK(serialized.Get() == serialized_before + 2);
+                    CHECK(dropped.Get() == dropped_before + 1);
+                }
+            }
+
+            AND_WHEN("the player leaves the game") {
+                app::PlayersManager::Instance().RemovePlayer(player->GetPlayerId());
+                publisher.Publish(game);
+                ioc.run();
+
+                THEN("the socket is closed and unsubscribed without serializing the state") {
+                    CHECK(serialized.Get() == serialized_before);
+                    CHECK(subscribers.Get() == subscribers_before);
+
+                    std::uint64_t dropped_before = dropped.Get();
+                    send_two_frames();
+                    CHECK(dropped.Get() == dropped_before);
+                }
+            }
+
+            AND_WHEN("the socket is gone") {
+                socket.reset();
+                publisher.Publish(game);
+
+                THEN("it is unsubscribed") {
+                    CHECK(serialized.Get() == serialized_before);
+                    CHECK(subscribers.Get() == subscribers_before);
+                }
+            }
+        }
+
+        app::PlayersManager::Instance().RemovePlayer(player->GetPlayerId());
+    }
+}
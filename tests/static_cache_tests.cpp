@@ -0,0 +1,142 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include "../src/static_cache.h"
+
+namespace {
+
+std::string Gunzip(const std::string & data) {
+    namespace io = boost::iostreams;
+
+    std::string out;
+    io::filtering_istream in;
+    in.push(io::gzip_decompressor());
+    in.push(io::array_source(data.data(), data.size()));
+    io::copy(in, io::back_inserter(out));
+
+    return out;
+}
+
+void WriteFile(const std::filesystem::path & path, const std::string & content) {
+    std::ofstream{path, std::ios::binary} << content;
+}
+
+} // namespace
+
+SCENARIO("Static assets") {
+    using static_cache::Encoding;
+    using namespace std::literals;
+
+    GIVEN("a compressible text") {
+        std::string text;
+        for (int i = 0; i < 100; ++i) {
+            text += "function f() { return 42; }\n";
+        }
+
+        static_cache::Asset asset = static_cache::StaticCache::MakeAsset(".js", text, 256);
+
+        THEN("it has compressed variants with their own ETags") {
+            CHECK(asset.content_type == "text/javascript"sv);
+            CHECK(asset.HasVariant(Encoding::GZIP));
+            CHECK(asset.HasVariant(Encoding::DEFLATE));
+            CHECK(asset.gzip.data.size() < text.size());
+            CHECK(Gunzip(asset.gzip.data) == text);
+
+            CHECK(asset.identity.etag.front() == '"');
+            CHECK(asset.identity.etag.back() == '"');
+            CHECK(asset.gzip.etag != asset.identity.etag);
+            CHECK(asset.deflate.etag != asset.gzip.etag);
+        }
+
+        THEN("the same content gets the same ETag") {
+            CHECK(static_cache::StaticCache::MakeAsset(".js", text, 256).identity.etag == asset.identity.etag);
+            CHECK(static_cache::StaticCache::MakeAsset(".js", text + " ", 256).identity.etag != asset.identity.etag);
+        }
+    }
+
+    GIVEN("a small file") {
+        static_cache::Asset asset = static_cache::StaticCache::MakeAsset(".png", "0123456789", 256);
+
+        THEN("it is not compressed") {
+            CHECK(asset.content_type == "image/png"sv);
+            CHECK_FALSE(asset.HasVariant(Encoding::GZIP));
+            CHECK_FALSE(asset.HasVariant(Encoding::DEFLATE));
+            CHECK(&asset.GetVariant(Encoding::GZIP) == &asset.gzip);
+        }
+    }
+}
+
+SCENARIO("Static cache") {
+    namespace fs = std::filesystem;
+    using namespace std::literals;
+
+    fs::path root = fs::temp_directory_path() / "static_cache_tests";
+    fs::remove_all(root);
+    fs::create_directories(root / "dir");
+
+    WriteFile(root / "index.html", "<html>index</html>");
+    WriteFile(root / "dir" / "index.html", "<html>dir</html>");
+    WriteFile(root / "big.bin", std::string(1000, 'x'));
+
+    GIVEN("a preloaded cache") {
+        static_cache::StaticCache cache{root, static_cache::StaticCache::Config{.max_file_size = 500, .check_interval = 0ms}};
+        cache.Preload();
+
+        THEN("files are found by their request paths") {
+            REQUIRE(cache.Find("/") != nullptr);
+            CHECK(cache.Find("/")->identity.data == "<html>index</html>"s);
+            CHECK(cache.Find("/dir/")->identity.data == "<html>dir</html>"s);
+            CHECK(cache.Find("/index.html") == cache.Find("/"));
+        }
+
+        THEN("missing files, directories and files over the size limit are not cached") {
+            CHECK(cache.Find("/missing.html") == nullptr);
+            CHECK(cache.Find("/dir") == nullptr);
+            CHECK(cache.Find("/big.bin") == nullptr);
+        }
+
+        WHEN("a file is changed") {
+            static_cache::AssetPtr before = cache.Find("/index.html");
+
+            WriteFile(root / "index.html", "<html>changed index</html>");
+            fs::last_write_time(root / "index.html", before->mtime + 1s);
+
+            THEN("it is reloaded and the old asset stays valid") {
+                static_cache::AssetPtr after = cache.Find("/index.html");
+
+                REQUIRE(after != nullptr);
+                CHECK(after->identity.data == "<html>changed index</html>"s);
+                CHECK(after->identity.etag != before->identity.etag);
+                CHECK(before->identity.data == "<html>index</html>"s);
+            }
+        }
+
+        WHEN("a file is removed") {
+            fs::remove(root / "dir" / "index.html");
+
+            THEN("it is dropped") {
+                CHECK(cache.Find("/dir/") == nullptr);
+            }
+        }
+    }
+
+    GIVEN("a cache without memory") {
+        static_cache::StaticCache cache{root, static_cache::StaticCache::Config{.max_total_size = 0}};
+        cache.Preload();
+
+        THEN("nothing is cached") {
+            CHECK(cache.Find("/") == nullptr);
+        }
+    }
+
+    fs::remove_all(root);
+}
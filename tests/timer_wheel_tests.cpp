@@ -0,0 +1,120 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include "../src/timer_wheel.h"
+
+SCENARIO("Hierarchical timer wheel") {
+    using Wheel = timer_wheel::HierarchicalTimerWheel<int>;
+
+    GIVEN("an empty wheel") {
+        Wheel wheel;
+        std::vector<int> expired;
+        auto collect = [&expired] (int id) { expired.emplace_back(id); };
+
+        WHEN("timers are scheduled on different levels") {
+            wheel.Schedule(1, 10);
+            wheel.Schedule(2, 100);
+            wheel.Schedule(3, 5000);
+            wheel.Schedule(4, 300000);
+            wheel.Schedule(5, 20000000);
+
+            THEN("each fires exactly when its deadline is reached") {
+                wheel.Advance(9, collect);
+                CHECK(expired.empty());
+
+                wheel.Advance(10, collect);
+                CHECK(expired == std::vector<int>{1});
+
+                wheel.Advance(4999, collect);
+                CHECK(expired == std::vector<int>{1, 2});
+
+                wheel.Advance(5000, collect);
+                CHECK(expired == std::vector<int>{1, 2, 3});
+
+                wheel.Advance(299999, collect);
+                CHECK(expired.size() == 3);
+
+                wheel.Advance(300000, collect);
+                CHECK(expired == std::vector<int>{1, 2, 3, 4});
+
+                wheel.Advance(19999999, collect);
+                CHECK(expired.size() == 4);
+
+                wheel.Advance(20000000, collect);
+                CHECK(expired == std::vector<int>{1, 2, 3, 4, 5});
+                CHECK(wheel.Size() == 0);
+            }
+        }
+
+        WHEN("the wheel jumps far ahead in one step") {
+            wheel.Schedule(1, 70);
+            wheel.Schedule(2, 4100);
+
+            wheel.Advance(100000, collect);
+
+            THEN("all overdue timers fire") {
+                std::sort(expired.begin(), expired.end());
+                CHECK(expired == std::vector<int>{1, 2});
+            }
+        }
+
+        WHEN("the wheel advances across 2^31 ticks") {
+            constexpr Wheel::Time FAR = Wheel::Time{1} << 31;
+
+            wheel.Schedule(1, 1);
+            wheel.Schedule(2, FAR - 5);
+            wheel.Schedule(3, FAR + 100);
+            wheel.Schedule(4, 3 * FAR);
+
+            THEN("empty slots are skipped and every timer fires on its deadline") {
+                wheel.Advance(FAR - 6, collect);
+                CHECK(expired == std::vector<int>{1});
+
+                wheel.Advance(FAR, collect);
+                CHECK(expired == std::vector<int>{1, 2});
+
+                wheel.Advance(FAR + 99, collect);
+                CHECK(expired.size() == 2);
+
+                wheel.Advance(FAR + 100, collect);
+                CHECK(expired == std::vector<int>{1, 2, 3});
+
+                wheel.Advance(3 * FAR - 1, collect);
+                CHECK(expired.size() == 3);
+
+                wheel.Advance(3 * FAR, collect);
+                CHECK(expired == std::vector<int>{1, 2, 3, 4});
+                CHECK(wheel.GetTime() == 3 * FAR);
+            }
+        }
+
+        WHEN("a timer is cancelled or rescheduled") {
+            wheel.Schedule(1, 50);
+            wheel.Schedule(2, 50);
+            wheel.Cancel(1);
+            wheel.Schedule(2, 500);
+
+            THEN("only the latest deadline of an active timer fires") {
+                wheel.Advance(499, collect);
+                CHECK(expired.empty());
+                CHECK_FALSE(wheel.IsScheduled(1));
+                CHECK(wheel.IsScheduled(2));
+
+                wheel.Advance(500, collect);
+                CHECK(expired == std::vector<int>{2});
+            }
+        }
+
+        WHEN("a timer is scheduled in the past") {
+            wheel.Advance(1000, collect);
+            wheel.Schedule(7, 10);
+
+            THEN("it fires on the next advance") {
+                wheel.Advance(1000, collect);
+                CHECK(expired == std::vector<int>{7});
+            }
+        }
+    }
+}